@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include "threads/interrupt.h"
 #include "threads/io.h"
+#include "threads/loader.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
 
@@ -20,6 +21,22 @@
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
+/* NOTE: [Improve] tickless idle 모드
+   true이면 idle 상태에서 다음 wakeup 시점까지 주기적인 타이머 인터럽트를 생략한다.
+   Controlled by kernel command-line option "-tickless". */
+bool timer_tickless;
+
+/* 8254 입력 주파수와 1 tick에 해당하는 카운트 값 (timer_init()에서 계산) */
+#define PIT_HZ 1193180
+static uint16_t pit_count_per_tick;
+
+/* one-shot 모드로 생략 중인 tick 수. 0이면 periodic 모드. */
+static int64_t oneshot_ticks;
+
+/* one-shot을 설정할 때 현재 tick에서 이미 지난 카운트.
+   one-shot은 이만큼 짧게 설정되어 다음 tick 경계에서 끝난다. */
+static uint16_t oneshot_base;
+
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
@@ -28,6 +45,10 @@ static intr_handler_func timer_interrupt;
 static bool too_many_loops(unsigned loops);
 static void busy_wait(int64_t loops);
 static void real_time_sleep(int64_t num, int32_t denom);
+static void timer_advance(int64_t elapsed, bool user);
+static void pit_set_periodic(void);
+static void pit_set_oneshot(uint16_t count);
+static uint16_t pit_read_count(void);
 
 /**
  * @brief 8254 프로그래머블 인터벌 타이머(PIT)를 설정하여 초당 PIT_FREQ 번 인터럽트가 발생하도록 하고, 해당 인터럽트를 등록합니다.
@@ -40,11 +61,8 @@ void timer_init(void)
 {
 	/* 8254 input frequency divided by TIMER_FREQ, rounded to
 	   nearest. */
-	uint16_t count = (1193180 + TIMER_FREQ / 2) / TIMER_FREQ;
-
-	outb(0x43, 0x34); /* CW: counter 0, LSB then MSB, mode 2, binary. */
-	outb(0x40, count & 0xff);
-	outb(0x40, count >> 8);
+	pit_count_per_tick = (PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ;
+	pit_set_periodic();
 
 	intr_register_ext(0x20, timer_interrupt, "8254 Timer"); /* 인터럽트 핸들러 등록 */
 }
@@ -136,39 +154,171 @@ void timer_print_stats(void)
 	printf("Timer: %" PRId64 " ticks\n", timer_ticks());
 }
 
+/**
+ * @brief idle 쓰레드가 hlt 하기 직전에 호출되어, 다음 wakeup 시점까지 타이머를 one-shot으로 설정합니다.
+ *
+ * tickless 모드가 아니거나 다음 wakeup이 1 tick 이내라면 아무것도 하지 않습니다.
+ * timer_idle_exit()이 남은 카운트로 설정한 one-shot이 진행 중일 때도 아무것도 하지 않습니다.
+ * 8254의 카운터는 16비트이므로 한 번에 생략할 수 있는 tick 수는 65535 / pit_count_per_tick 으로 제한됩니다.
+ * 인터럽트가 비활성화된 상태에서 호출되어야 합니다.
+ */
+void timer_idle_enter(void)
+{
+	int64_t delta;
+	int64_t max_ticks = UINT16_MAX / pit_count_per_tick;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	/* timer_idle_exit()이 남긴 짧은 one-shot이 아직 끝나지 않았다면 그대로 둔다 */
+	if (!timer_tickless || oneshot_ticks > 0)
+		return;
+
+	delta = thread_next_wakeup() - ticks;
+	if (delta <= 1)
+		return;
+	if (delta > max_ticks)
+		delta = max_ticks;
+
+	oneshot_ticks = delta;
+	pit_set_oneshot(delta * pit_count_per_tick);
+}
+
+/**
+ * @brief idle 쓰레드가 hlt에서 깨어난 직후 호출되어, 생략된 tick을 보정하고 periodic 모드로 되돌립니다.
+ *
+ * 타이머 인터럽트로 깨어났다면 timer_interrupt()에서 이미 처리되었으므로 아무것도 하지 않습니다.
+ * 다른 인터럽트로 먼저 깨어났다면 카운터를 읽어 실제로 경과한 tick만큼만 보정합니다.
+ * 한 tick에 못 미치는 나머지는 버리지 않고, 남은 카운트만큼 one-shot을 다시 설정해
+ * 다음 타이머 인터럽트가 원래의 tick 경계에 오도록 합니다.
+ */
+void timer_idle_exit(void)
+{
+	enum intr_level old_level = intr_disable();
+
+	if (oneshot_ticks > 0)
+	{
+		uint32_t programmed = oneshot_ticks * pit_count_per_tick - oneshot_base;
+		uint16_t remain = pit_read_count();
+		uint32_t passed;
+		int64_t elapsed;
+
+		/* 카운터가 이미 0을 지나 감소 중이라면 전부 경과한 것으로 처리 */
+		if (remain > programmed)
+			remain = 0;
+		passed = oneshot_base + (programmed - remain);
+		elapsed = passed / pit_count_per_tick;
+		oneshot_base = passed % pit_count_per_tick;
+
+		/* 진행 중인 tick의 남은 카운트가 지나면 인터럽트가 오도록 하고, 그때 periodic으로 복귀 */
+		if (oneshot_base > 0)
+		{
+			oneshot_ticks = 1;
+			pit_set_oneshot(pit_count_per_tick - oneshot_base);
+		}
+		else
+		{
+			oneshot_ticks = 0;
+			pit_set_periodic();
+		}
+		if (elapsed > 0)
+			timer_advance(elapsed, false);
+		thread_wakeup(ticks);
+	}
+	intr_set_level(old_level);
+}
+
 /* Timer interrupt handler. */
 
 /**
  * @brief 타이머 인터럽트 핸들러
  *
- * @param UNUSED 인터럽트 프레임 (현재 사용되지 않음)
+ * @param args 인터럽트 프레임 (사용자 모드에서 인터럽트되었는지 판별하는 데 사용)
  */
 static void
-timer_interrupt(struct intr_frame *args UNUSED)
+timer_interrupt(struct intr_frame *args)
 {
-	ticks++;
-	thread_tick();
+	int64_t elapsed = 1;
 
-	/**
-	 * NOTE: [1.3]
-	 * - 4 tick마다 모든 쓰레드의 우선순위 재계산
-	 * - 1 sec마다 load_avg, recent_cpu 재계산
-	 */
-	if (thread_mlfqs)
+	/* NOTE: [Improve] one-shot 모드였다면 생략된 tick을 한 번에 보정하고 periodic 모드로 복귀 */
+	if (oneshot_ticks > 0)
 	{
-		thread_incr_recent_cpu();
+		elapsed = oneshot_ticks;
+		oneshot_ticks = 0;
+		oneshot_base = 0;
+		pit_set_periodic();
+	}
 
-		if (timer_ticks() % 4 == 0)
-			thread_all_calc_priority();
+	/* NOTE: [Improve] 인터럽트된 코드 세그먼트로 user/kernel tick을 구분 */
+	timer_advance(elapsed, args->cs == SEL_UCSEG);
+	thread_wakeup(ticks); /* 지정된 틱 시간에 깨어날 스레드를 깨우는 함수 호출 */
+}
 
-		if (timer_ticks() % TIMER_FREQ == 0)
+/**
+ * @brief ELAPSED tick 만큼 시간을 진행시키며, 각 tick마다 필요한 처리를 수행합니다.
+ *
+ * @param elapsed 진행시킬 tick 수
+ * @param user 사용자 모드 실행 중에 흐른 tick인지 여부
+ */
+static void
+timer_advance(int64_t elapsed, bool user)
+{
+	while (elapsed-- > 0)
+	{
+		ticks++;
+		thread_tick(user);
+
+		/**
+		 * NOTE: [1.3/Improve]
+		 * - 4 tick마다 실행 중인 쓰레드의 우선순위 재계산
+		 *   (recent_cpu가 바뀌는 쓰레드는 실행 중인 쓰레드뿐이므로)
+		 * - 1 sec마다 load_avg, recent_cpu 재계산
+		 */
+		if (thread_mlfqs)
 		{
-			calc_load_avg();
-			thread_all_calc_recent_cpu();
+			thread_incr_recent_cpu();
+
+			if (ticks % 4 == 0)
+				thread_calc_priority(thread_current());
+
+			if (ticks % TIMER_FREQ == 0)
+			{
+				calc_load_avg();
+				thread_ready_calc_recent_cpu();
+			}
 		}
 	}
+}
 
-	thread_wakeup(ticks); /* 지정된 틱 시간에 깨어날 스레드를 깨우는 함수 호출 */
+/* Programs counter 0 to interrupt every pit_count_per_tick
+   input cycles. */
+static void
+pit_set_periodic(void)
+{
+	outb(0x43, 0x34); /* CW: counter 0, LSB then MSB, mode 2, binary. */
+	outb(0x40, pit_count_per_tick & 0xff);
+	outb(0x40, pit_count_per_tick >> 8);
+}
+
+/* Programs counter 0 to interrupt once after COUNT input
+   cycles. */
+static void
+pit_set_oneshot(uint16_t count)
+{
+	outb(0x43, 0x30); /* CW: counter 0, LSB then MSB, mode 0, binary. */
+	outb(0x40, count & 0xff);
+	outb(0x40, count >> 8);
+}
+
+/* Latches and returns the current value of counter 0. */
+static uint16_t
+pit_read_count(void)
+{
+	uint8_t lo, hi;
+
+	outb(0x43, 0x00); /* CW: counter 0, counter latch command. */
+	lo = inb(0x40);
+	hi = inb(0x40);
+	return ((uint16_t)hi << 8) | lo;
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
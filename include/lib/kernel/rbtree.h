@@ -0,0 +1,58 @@
+#ifndef __LIB_KERNEL_RBTREE_H
+#define __LIB_KERNEL_RBTREE_H
+
+/* Red-black tree.
+ *
+ * A self-balancing binary search tree with O(log n) insertion
+ * and removal.  Like the lists in list.h, it does not allocate
+ * memory: each structure that can be in a tree embeds a struct
+ * rb_node member, and rb_entry converts a struct rb_node back
+ * to the structure that contains it.
+ *
+ * The tree keeps a pointer to its leftmost (smallest) node, so
+ * rb_first() takes constant time.  Elements that compare equal
+ * are kept in insertion order. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Tree node. */
+struct rb_node {
+	struct rb_node *parent;     /* Parent node, or null for the root. */
+	struct rb_node *left;       /* Left child. */
+	struct rb_node *right;      /* Right child. */
+	bool red;                   /* Node color. */
+};
+
+/* Tree. */
+struct rb_tree {
+	struct rb_node *root;       /* Root node. */
+	struct rb_node *leftmost;   /* Smallest node. */
+};
+
+/* Converts pointer to tree node RB_NODE into a pointer to the
+   structure that RB_NODE is embedded inside.  Supply the name
+   of the outer structure STRUCT and the member name MEMBER of
+   the tree node. */
+#define rb_entry(RB_NODE, STRUCT, MEMBER)               \
+	((STRUCT *) ((uint8_t *) &(RB_NODE)->parent     \
+		- offsetof (STRUCT, MEMBER.parent)))
+
+/* Compares the value of two tree nodes A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool rb_less_func (const struct rb_node *a,
+                           const struct rb_node *b,
+                           void *aux);
+
+void rb_init (struct rb_tree *);
+void rb_insert (struct rb_tree *, struct rb_node *,
+                rb_less_func *, void *aux);
+void rb_remove (struct rb_tree *, struct rb_node *);
+
+struct rb_node *rb_first (struct rb_tree *);
+struct rb_node *rb_next (struct rb_node *);
+bool rb_empty (struct rb_tree *);
+
+#endif /* lib/kernel/rbtree.h */
@@ -0,0 +1,32 @@
+#ifndef __LIB_RUSAGE_H
+#define __LIB_RUSAGE_H
+
+#include <stdint.h>
+
+/* Which usage getrusage() reports. */
+#define RUSAGE_SELF 0       /* The calling process. */
+#define RUSAGE_CHILDREN (-1) /* All waited-for descendants. */
+
+/* Resource usage of a thread (or of its waited-for children).
+   Times are measured in timer ticks. */
+struct rusage {
+	int64_t ru_utime;     /* Ticks spent in user mode. */
+	int64_t ru_stime;     /* Ticks spent in kernel mode. */
+	int64_t ru_nvcsw;     /* Voluntary context switches (blocked). */
+	int64_t ru_nivcsw;    /* Involuntary context switches (preempted). */
+	int64_t ru_faults;    /* Page faults. */
+	int64_t ru_nsyscalls; /* System calls. */
+};
+
+/* Adds SRC into DST. */
+static inline void
+rusage_add (struct rusage *dst, const struct rusage *src) {
+	dst->ru_utime += src->ru_utime;
+	dst->ru_stime += src->ru_stime;
+	dst->ru_nvcsw += src->ru_nvcsw;
+	dst->ru_nivcsw += src->ru_nivcsw;
+	dst->ru_faults += src->ru_faults;
+	dst->ru_nsyscalls += src->ru_nsyscalls;
+}
+
+#endif /* lib/rusage.h */
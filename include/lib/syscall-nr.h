@@ -36,6 +36,14 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Resource accounting. */
+	SYS_GETRUSAGE,              /* Report CPU and scheduling usage. */
+
+	/* User threads. */
+	SYS_THREAD_CREATE,          /* Start a thread in this process. */
+	SYS_THREAD_JOIN,            /* Wait for a thread to exit. */
+	SYS_FUTEX,                  /* Wait on or wake a user memory word. */
 };
 
 #endif /* lib/syscall-nr.h */
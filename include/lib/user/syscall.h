@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <rusage.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -38,6 +39,31 @@ void close(int fd);
 
 int dup2(int oldfd, int newfd);
 
+/* Resource accounting. */
+int getrusage(int who, struct rusage *usage);
+
+/* User threads sharing the caller's address space and open files.
+   A thread ends when its function returns or calls uthread_exit();
+   calling exit() from such a thread also ends only that thread.
+   When the main thread exits, the process waits for the remaining
+   threads, which are terminated at their next system call. */
+typedef int uthread_t;
+typedef void uthread_func(void *aux);
+#define UTHREAD_ERROR ((uthread_t) - 1)
+
+uthread_t uthread_create(uthread_func *, void *aux);
+int uthread_join(uthread_t);
+void uthread_exit(int status) NO_RETURN;
+
+/* Futex operations.  FUTEX_WAIT sleeps while *UADDR == VAL and
+   returns 0 once woken, or -1 at once if the value differs.
+   FUTEX_WAKE wakes up to VAL waiters, highest priority first, and
+   returns how many were woken. */
+#define FUTEX_WAIT 0
+#define FUTEX_WAKE 1
+
+int futex(int *uaddr, int op, int val);
+
 /* Project 3 and optionally project 4. */
 void *mmap(void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap(void *addr);
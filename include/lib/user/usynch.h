@@ -0,0 +1,32 @@
+#ifndef __LIB_USER_USYNCH_H
+#define __LIB_USER_USYNCH_H
+
+#include <stdbool.h>
+
+/* Mutex for threads created by uthread_create().  Acquiring and
+   releasing an uncontended mutex never enters the kernel; only
+   waiters sleep in FUTEX_WAIT. */
+struct umutex {
+	int state;                  /* 0: free, 1: held, 2: held with waiters. */
+};
+
+#define UMUTEX_INITIALIZER { 0 }
+
+void umutex_init (struct umutex *);
+void umutex_acquire (struct umutex *);
+bool umutex_try_acquire (struct umutex *);
+void umutex_release (struct umutex *);
+
+/* Condition variable used together with a umutex. */
+struct ucond {
+	int seq;                    /* Bumped by every signal/broadcast. */
+};
+
+#define UCOND_INITIALIZER { 0 }
+
+void ucond_init (struct ucond *);
+void ucond_wait (struct ucond *, struct umutex *);
+void ucond_signal (struct ucond *);
+void ucond_broadcast (struct ucond *);
+
+#endif /* lib/user/usynch.h */
@@ -4,7 +4,17 @@
 #include <debug.h>
 #include <stddef.h>
 
+/* Per-thread magazine: a small cache of free blocks of one size
+   class, kept in struct thread.  See malloc.c for details. */
+#define MALLOC_MAG_CLASSES 7        /* 16, 32, ..., 1024-byte blocks. */
+struct malloc_magazine {
+	void *head;                 /* Free blocks, linked through their first word. */
+	unsigned cnt;               /* Number of blocks on HEAD. */
+};
+
 void malloc_init (void);
+void malloc_drain (void);
+void malloc_print_stats (void);
 void *malloc (size_t) __attribute__ ((malloc));
 void *calloc (size_t, size_t) __attribute__ ((malloc));
 void *realloc (void *, size_t);
@@ -0,0 +1,30 @@
+#ifndef THREADS_SCHEDTRACE_H
+#define THREADS_SCHEDTRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* NOTE: [Improve] 스케줄러 이벤트 추적
+   Controlled by kernel command-line option "-sched-trace". */
+
+/* 기록되는 이벤트 종류 */
+enum sched_event
+{
+	SCHED_SWITCH,  /* schedule()에서 쓰레드 전환. tid -> arg */
+	SCHED_BLOCK,   /* thread_block() */
+	SCHED_UNBLOCK, /* thread_unblock() */
+	SCHED_DONATE,  /* 우선순위 donation. tid에게 priority를 arg로 */
+	SCHED_WAKEUP,  /* thread_wakeup()에서 잠든 쓰레드를 깨움 */
+};
+
+struct thread;
+
+extern bool sched_trace_enabled;
+
+void sched_trace_event(enum sched_event, int tid, int priority, int arg);
+void sched_trace_ready(struct thread *, bool woken);
+void sched_trace_run(struct thread *);
+void sched_trace_print_stats(void);
+void sched_trace_dump(char **argv);
+
+#endif /* threads/schedtrace.h */
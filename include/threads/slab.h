@@ -0,0 +1,37 @@
+#ifndef THREADS_SLAB_H
+#define THREADS_SLAB_H
+
+#include <list.h>
+#include <stddef.h>
+#include "threads/synch.h"
+
+/* Object cache.  Hands out objects of one fixed size, carved
+   out of whole pages ("slabs") obtained from the page allocator.
+   See slab.c for details. */
+struct slab_cache {
+	const char *name;           /* Name, for statistics. */
+	size_t obj_size;            /* Object size, rounded for alignment. */
+	size_t objs_per_slab;       /* Number of objects in each slab. */
+	void (*ctor) (void *);      /* Object constructor, or null. */
+	struct spinlock lock;       /* Mutual exclusion. */
+	struct list partial;        /* Slabs with at least one free object. */
+	struct list full;           /* Slabs with no free objects. */
+	size_t empty_cnt;           /* Slabs on PARTIAL with no object in use. */
+	struct list_elem elem;      /* Element in the list of all caches. */
+
+	/* Statistics. */
+	size_t slab_cnt;            /* Slabs currently owned. */
+	size_t in_use;              /* Objects currently allocated. */
+	long long alloc_cnt;        /* Calls to slab_alloc(). */
+	long long grow_cnt;         /* Slabs obtained from palloc. */
+	long long shrink_cnt;       /* Slabs given back to palloc. */
+};
+
+void slab_init (void);
+void slab_cache_init (struct slab_cache *, const char *name, size_t size,
+		void (*ctor) (void *));
+void *slab_alloc (struct slab_cache *);
+void slab_free (struct slab_cache *, void *);
+void slab_print_stats (void);
+
+#endif /* threads/slab.h */
@@ -0,0 +1,32 @@
+#ifndef THREADS_SWITCH_H
+#define THREADS_SWITCH_H
+
+#include <stdint.h>
+
+/* NOTE: [Improve] 커널 모드 쓰레드 전환
+   두 쓰레드가 모두 커널 모드에 있을 때는 System V ABI상 callee-saved 레지스터
+   (rbx, rbp, r12-r15)와 스택 포인터만 보존하면 된다. 나머지 레지스터는
+   schedule()을 호출한 C 코드가 이미 caller-saved로 취급하고 있다.
+   사용자 모드 진입은 여전히 do_iret()을 사용한다. */
+
+/* thread_switch()가 스택에 쌓는 프레임. */
+struct switch_frame {
+	uint64_t r15;
+	uint64_t r14;
+	uint64_t r13;
+	uint64_t r12;
+	uint64_t rbp;
+	uint64_t rbx;
+	void (*rip) (void);         /* thread_switch()가 돌아갈 주소. */
+};
+
+/* Saves the callee-saved registers of the running thread on its
+   stack, stores its stack pointer in *CUR_RSP, and resumes the
+   thread whose saved stack pointer is NEXT_RSP. */
+void thread_switch (uint64_t *cur_rsp, uint64_t next_rsp);
+
+/* Where a new thread's first thread_switch() returns to.  Calls
+   the function in rbx with r12 and r13 as its arguments. */
+void thread_switch_entry (void);
+
+#endif /* threads/switch.h */
@@ -3,15 +3,64 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
+
+/* NOTE: [Improve] Spin lock.
+   CPU 간 상호 배제를 위한 가장 낮은 수준의 lock으로, 잠들지 않고 busy-wait 한다.
+   인터럽트가 비활성화된 상태에서만 획득할 수 있으며, 짧은 임계 구역(page pool 등)에만 사용한다. */
+struct spinlock
+{
+	volatile int locked;	  /* 1이면 누군가 보유 중 */
+	const char *name;		  /* lockstat 이름 (집계하지 않으면 NULL) */
+	struct lock_class *class; /* lockstat 집계 대상 (아직 찾지 않았으면 NULL) */
+	uint64_t acquire_tsc;	  /* 획득한 시각 (lockstat) */
+};
+
+void spinlock_init_named(struct spinlock *, const char *name);
+#define spinlock_init(LOCK) spinlock_init_named(LOCK, #LOCK)
+void spinlock_acquire(struct spinlock *);
+bool spinlock_try_acquire(struct spinlock *);
+void spinlock_release(struct spinlock *);
+
+/* NOTE: [Improve] Lock contention statistics (lockstat).
+   같은 이름으로 초기화된 lock/semaphore/spinlock들은 하나의 lock_class로 묶여 집계된다.
+   lock_init(), sema_init(), spinlock_init()은 인자로 넘긴 식 자체(예: "&filesys_lock")를 이름으로 쓴다.
+   초기화할 때는 이름만 저장하고, lockstat이 켜져 있을 때 처음 획득하면서 lock_class를 찾는다.
+   Controlled by kernel command-line option "-lockstat". */
+enum lock_class_type
+{
+	LOCK_CLASS_SEMA, /* semaphore */
+	LOCK_CLASS_LOCK, /* lock */
+	LOCK_CLASS_SPIN	 /* spinlock */
+};
+
+struct lock_class
+{
+	const char *name;		   /* 이름 */
+	enum lock_class_type type; /* 종류 */
+	uint64_t acquired;		   /* 획득 (sema_down) 횟수 */
+	uint64_t contended;		   /* 기다려야 했던 획득 횟수 */
+	uint64_t wait_total;	   /* 기다린 시간 합 (TSC cycle) */
+	uint64_t wait_max;		   /* 가장 오래 기다린 시간 */
+	uint64_t hold_total;	   /* 보유 시간 합 (lock/spinlock만) */
+	uint64_t hold_max;		   /* 가장 오래 보유한 시간 (lock/spinlock만) */
+};
+
+extern bool lockstat_enabled;
+
+void lockstat_print_stats(void);
 
 /* A counting semaphore. */
 struct semaphore
 {
-	unsigned value;		 /* Current value. */
-	struct list waiters; /* List of waiting threads. */
+	unsigned value;			/* Current value. */
+	struct thread *waiters; /* NOTE: [Improve] 대기자들의 우선순위 max-heap (루트가 최고 우선순위) */
+	const char *name;		  /* NOTE: [Improve] lockstat 이름 (집계하지 않으면 NULL) */
+	struct lock_class *class; /* NOTE: [Improve] lockstat 집계 대상 (아직 찾지 않았으면 NULL) */
 };
 
-void sema_init(struct semaphore *, unsigned value); /* 새로운 세마포어 구조체인 sema를 주어진 초기값으로 초기화 */
+void sema_init_named(struct semaphore *, unsigned value, const char *name); /* 새로운 세마포어 구조체인 sema를 주어진 초기값으로 초기화 */
+#define sema_init(SEMA, VALUE) sema_init_named(SEMA, VALUE, #SEMA)
 void sema_down(struct semaphore *);					/* "down" or "P" 연산을 sema에 실행. 세마의 값이 양수가 될 때까지 기다렸다가 양수가 되면 1만큼 빼게 된다. */
 bool sema_try_down(struct semaphore *);				/* sema에 "down" or "P" 연산을 기다리지 않고 시도. 성공적으로 감소 시 true 리턴, 이미 0이었으면 false 리턴 */
 void sema_up(struct semaphore *);					/* "up" or "V" 연산을 sema에 실행. */
@@ -21,19 +70,51 @@ void sema_self_test(void);
 struct lock
 {
 	struct thread *holder;		/* Thread holding lock (for debugging). */
-	struct semaphore semaphore; /* Binary semaphore controlling access. */
+	struct semaphore semaphore; /* Binary semaphore controlling access. (대기자 heap 포함) */
+	struct list_elem elem;		/* NOTE: [Improve] holder의 held_locks 원소 */
+	const char *name;			/* NOTE: [Improve] lockstat 이름 (집계하지 않으면 NULL) */
+	struct lock_class *class;	/* NOTE: [Improve] lockstat 집계 대상 (아직 찾지 않았으면 NULL) */
+	uint64_t acquire_tsc;		/* NOTE: [Improve] 획득한 시각 (lockstat) */
 };
 
-void lock_init(struct lock *);		  /* 새로운 lock 구조체 초기화 */
+void lock_init_named(struct lock *, const char *name); /* 새로운 lock 구조체 초기화 */
+#define lock_init(LOCK) lock_init_named(LOCK, #LOCK)
 void lock_acquire(struct lock *);	  /* 현재 쓰레드에서 lock 획득. 현재의 lock owner가 lock을 놓아주기를 기다림 */
 bool lock_try_acquire(struct lock *); /* 기다리지 않고 현재 쓰레드가 lock을 획득하도록 시도. 성공 여부 리턴 */
 void lock_release(struct lock *);	  /* lock을 놓아준다. */
 bool lock_held_by_current_thread(const struct lock *);
 
+/* NOTE: [Improve] Reader-writer lock. */
+struct rwlock
+{
+	struct thread *writer;		/* 쓰기 보유자 (없으면 NULL) */
+	int readers;				/* 읽기 보유자 수 */
+	struct list holders;		/* 보유자들의 struct rwlock_hold 목록 */
+	struct thread *read_heap;	/* 기다리는 reader의 우선순위 max-heap */
+	struct thread *write_heap;	/* 기다리는 writer의 우선순위 max-heap */
+};
+
+/* 쓰레드 하나가 rwlock 하나를 보유하고 있다는 기록.
+   struct thread_ext의 rw_holds 배열에 들어있다. */
+#define RWLOCK_HOLD_MAX 4
+struct rwlock_hold
+{
+	struct rwlock *rwlock;	/* 보유 중인 rwlock (빈 칸이면 NULL) */
+	struct thread *thread;	/* 보유자 */
+	struct list_elem elem;	/* rwlock의 holders 원소 */
+};
+
+void rwlock_init(struct rwlock *);
+void rwlock_acquire_read(struct rwlock *);
+void rwlock_acquire_write(struct rwlock *);
+void rwlock_release_read(struct rwlock *);
+void rwlock_release_write(struct rwlock *);
+bool rwlock_held_by_current_thread(const struct rwlock *);
+
 /* Condition variable. */
 struct condition
 {
-	struct list waiters; /* List of waiting threads. */
+	struct thread *waiters; /* NOTE: [Improve] 대기자들의 우선순위 max-heap */
 };
 
 void cond_init(struct condition *);
@@ -41,11 +122,9 @@ void cond_wait(struct condition *, struct lock *);
 void cond_signal(struct condition *, struct lock *);
 void cond_broadcast(struct condition *, struct lock *);
 
-bool cmp_condition(struct list_elem *a, struct list_elem *b, void *aux);
-bool cmp_donation(struct list_elem *a, struct list_elem *b, void *aux);
-void remove_donations(struct lock *lock);
 void donate_priority(void);
 void update_donate_priority(void);
+void waiter_heap_update(struct thread *t);
 /* Optimization barrier.
  *
  * The compiler will not reorder operations across an
@@ -3,9 +3,12 @@
 
 #include <debug.h>
 #include <list.h>
+#include <rbtree.h>
+#include <rusage.h>
 #include <stdint.h>
 #include "threads/interrupt.h"
 #include "threads/fixed_point.h"
+#include "threads/malloc.h"
 #include "threads/synch.h"
 #include "filesys/file.h"
 #ifdef VM
@@ -58,7 +61,7 @@ typedef int tid_t;
  *           |                                 |
  *           +---------------------------------+
  *           |              magic              |
- *           |            intr_frame           |
+ *           |             ctx_rsp             |
  *           |                :                |
  *           |                :                |
  *           |               name              |
@@ -85,12 +88,33 @@ typedef int tid_t;
  * the `magic' member of the running thread's `struct thread' is
  * set to THREAD_MAGIC.  Stack overflow will normally change this
  * value, triggering the assertion. */
+/* NOTE: [Improve] struct thread에서 떼어낸 크고 드물게 쓰는 데이터
+ * struct thread가 커질수록 같은 페이지의 커널 스택이 줄어들므로,
+ * 이 멤버들은 slab에서 따로 할당해 struct thread의 ext로 가리킨다.
+ * 쓰레드 페이지와 함께 할당되고 함께 해제된다. */
+struct thread_ext
+{
+	struct rwlock_hold rw_holds[RWLOCK_HOLD_MAX]; /* 보유 중인 rwlock 기록 */
+
+	/* 자원 사용량 (getrusage) */
+	struct rusage ru;		   /* 이 쓰레드가 사용한 자원 */
+	struct rusage ru_children; /* wait으로 회수한 자식 프로세스들이 사용한 자원의 합 */
+
+	/* malloc 크기별 magazine (descriptor lock 없이 쓰는 빈 블록 캐시) */
+	struct malloc_magazine malloc_mag[MALLOC_MAG_CLASSES];
+
+	/* NOTE: [2.5] fork를 위한 if 구조체 */
+	struct intr_frame parent_if;
+};
+
 /* The `elem' member has a dual purpose.  It can be an element in
- * the run queue (thread.c), or it can be an element in a
- * semaphore wait list (synch.c).  It can be used these two ways
- * only because they are mutually exclusive: only a thread in the
+ * the run queue (thread.c), or it can be an element in the EDF
+ * throttled list (thread.c).  It can be used these two ways only
+ * because they are mutually exclusive: only a thread in the
  * ready state is on the run queue, whereas only a thread in the
- * blocked state is on a semaphore wait list. */
+ * blocked state is on the throttled list.  Semaphore, condition
+ * variable and rwlock waiters are linked through the waiter_*
+ * members instead. */
 struct thread
 {
 	/* Owned by thread.c. */
@@ -99,22 +123,57 @@ struct thread
 	char name[16];			   /* Name (for debugging purposes). */
 	int priority;			   /* Priority. */
 	int64_t wakeup_tick;	   /* wakeup 할 시간 저장 */
-	struct list donations;
-	struct list_elem d_elem;
-	struct list_elem donation_elem;
+	struct thread *sleep_child;	  /* sleep heap에서의 첫 번째 자식 */
+	struct thread *sleep_sibling; /* sleep heap에서의 다음 형제 */
 	int origin_priority;
 	struct lock *wait_on_lock;
+	/* NOTE: [Improve] donation을 위한 데이터 */
+	struct list held_locks;		   /* 보유 중인 lock 목록 */
+	struct thread **wait_heap;	   /* 들어가 있는 대기자 heap (semaphore/condition/rwlock), 없으면 NULL */
+	uint64_t wait_seq;			   /* 대기자 heap에 들어간 순서 (같은 우선순위끼리 FIFO) */
+	struct thread *waiter_child;   /* 대기자 heap에서의 첫 번째 자식 */
+	struct thread *waiter_sibling; /* 대기자 heap에서의 다음 형제 */
+	struct thread *waiter_prev;	   /* 대기자 heap에서의 이전 형제 (첫 자식이면 부모) */
+	struct rwlock *wait_on_rwlock; /* 기다리고 있는 rwlock */
 
 	/* Shared between thread.c and synch.c. */
 	struct list_elem elem; /* List element. */
 
+	/* NOTE: [Improve] 스케줄러 지연 시간 측정 (schedtrace.c) */
+	uint64_t ready_tsc; /* run queue에 들어간 시각 */
+	bool woken;			/* BLOCKED 상태에서 깨어나 run queue에 들어왔는지 여부 */
+
 	/* NOTE: [1.3] MLFQ를 위한 데이터 추가 - nice, recent_cpu */
 	int nice;			/* 쓰레드의 친절함을 나타내는 지표 */
 	int32_t recent_cpu; /* 쓰레드의 최근 CPU 사용량을 나타내는 지표 */
+	int64_t recent_cpu_sec; /* recent_cpu에 decay가 마지막으로 적용된 시점 (초) */
+	bool fixed_priority;	/* NOTE: [Improve] MLFQS에서도 우선순위를 재계산하지 않음 (커널 worker) */
+
+	/* NOTE: [Improve] 적응형 time slice */
+	int slice_shift; /* 우선순위별 기본 slice를 늘리는 정도 (slice 소진 시 증가, 양보 시 감소) */
+
+	/* NOTE: [Improve] CFS 정책을 위한 데이터 */
+	uint64_t vruntime;		 /* weight로 보정한 누적 실행 시간 */
+	struct rb_node cfs_node; /* run queue의 cfs_tree 원소 */
+
+	/* NOTE: [Improve] EDF 실시간 스케줄링 클래스 (시간 단위는 tick) */
+	bool edf;				  /* EDF 클래스 여부 */
+	bool edf_throttled;		  /* 이번 주기의 runtime을 다 써서 다음 주기를 기다리는 중 */
+	bool edf_missed;		  /* 이번 주기의 deadline을 넘겼는지 여부 */
+	int64_t edf_runtime;	  /* 주기마다 보장받는 실행 시간 */
+	int64_t edf_period;		  /* 주기 */
+	int64_t edf_rel_deadline; /* 주기 시작부터 deadline까지의 시간 */
+	int64_t edf_util;		  /* 이용률 (runtime / deadline, EDF_UTIL_SCALE 단위) */
+	int64_t edf_deadline;	  /* 이번 주기의 절대 deadline */
+	int64_t edf_next_period;  /* 다음 주기가 시작되는 tick */
+	int64_t edf_budget;		  /* 이번 주기에 남은 실행 시간 */
 
 	/* NOTE: [Improve] all_list element */
 	struct list_elem all_elem;
 
+	/* NOTE: [Improve] 스레드 페이지 밖에 둔 데이터 (struct thread_ext) */
+	struct thread_ext *ext;
+
 	/* NOTE: [2.3] 프로세스 계층 구조 구현을 위한 데이터 추가 */
 	/* exit 호출 시 종료 status */
 	int exit_status;
@@ -122,9 +181,6 @@ struct thread
 	/* NOTE: [2.5] 실행 중인 파일 포인터 추가 */
 	struct file *run_file;
 
-	/* NOTE: [2.5] fork를 위한 if 구조체 */
-	struct intr_frame parent_if;
-
 	/* NOTE: [2.4] 파일 디스크립터 테이블 추가 */
 	/* 파일 디스크립터 테이블 */
 	struct file **fdt;
@@ -144,17 +200,28 @@ struct thread
 #ifdef USERPROG
 	/* Owned by userprog/process.c. */
 	uint64_t *pml4; /* Page map level 4 */
+
+	/* NOTE: [Improve] 같은 주소 공간을 공유하는 사용자 쓰레드 (uthread_create) */
+	struct thread *leader;		 /* pml4/spt/fdt를 소유한 쓰레드 (일반 프로세스는 자기 자신) */
+	struct list group;			 /* leader: 이 프로세스에서 만든 쓰레드 목록 */
+	struct list_elem group_elem; /* group 원소 */
+	bool group_exiting;			 /* leader: 프로세스가 종료 중인지 여부 */
+	bool joined;				 /* 다른 쓰레드가 join(회수)하고 있는지 여부 */
+	int ustack_slot;			 /* 사용 중인 사용자 스택 슬롯 (leader는 -1) */
+	uint32_t ustack_used;		 /* leader: 사용 중인 스택 슬롯 bitmap */
+	uint32_t ustack_mapped;		 /* leader: 페이지를 준비해 둔 스택 슬롯 bitmap */
 #endif
 
 #ifdef VM
 	/* Table for whole virtual memory owned by thread. */
 	struct supplemental_page_table spt;
+	struct lock vm_lock; /* NOTE: [Improve] leader: spt를 공유하는 쓰레드 사이의 page fault/mmap 직렬화 */
 	void *rsp;
 #endif
 
 	/* Owned by thread.c. */
-	struct intr_frame tf; /* Information for switching */
-	unsigned magic;		  /* Detects stack overflow. */
+	uint64_t ctx_rsp; /* NOTE: [Improve] thread_switch()가 저장한 커널 스택 포인터 */
+	unsigned magic;	  /* Detects stack overflow. */
 };
 
 /* If false (default), use round-robin scheduler.
@@ -162,10 +229,14 @@ struct thread
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* NOTE: [Improve] If true, use the weighted fair-share (CFS) scheduler.
+   Controlled by kernel command-line option "-cfs". */
+extern bool thread_cfs;
+
 void thread_init(void);
 void thread_start(void);
 
-void thread_tick(void);
+void thread_tick(bool user);
 void thread_print_stats(void);
 
 typedef void thread_func(void *aux);
@@ -183,9 +254,13 @@ void thread_compare_yield(void);
 void thread_yield(void);
 void thread_sleep(int64_t wakeup_tick);
 void thread_wakeup(int64_t curr_tick);
+int64_t thread_next_wakeup(void);
+bool thread_set_edf(int64_t runtime, int64_t period, int64_t deadline);
+void thread_clear_edf(void);
 
 int thread_get_priority(void);
 void thread_set_priority(int);
+void thread_change_priority(struct thread *t, int new_priority);
 
 int thread_get_nice(void);
 void thread_set_nice(int);
@@ -196,8 +271,7 @@ void thread_calc_priority(struct thread *t);
 void thread_calc_recent_cpu(struct thread *t);
 void thread_incr_recent_cpu(void);
 void calc_load_avg(void);
-void thread_all_calc_priority(void);
-void thread_all_calc_recent_cpu(void);
+void thread_ready_calc_recent_cpu(void);
 
 // static cmp_priority(const struct list_elem *a_, const struct list_elem *b_, void *aux);
 
@@ -207,4 +281,7 @@ bool cmp_priority(const struct list_elem *a_, const struct list_elem *b_, void *
 
 struct thread *get_child_process(tid_t pid);
 
+struct file **thread_fdt_alloc(void);
+void thread_fdt_free(struct file **fdt);
+
 #endif /* threads/thread.h */
@@ -0,0 +1,34 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <stdbool.h>
+
+/* NOTE: [Improve] Kernel work queues.
+   인터럽트 핸들러에서 오래 걸리는 일을 바로 하지 않고 work로 등록해두면,
+   우선순위별 커널 worker 쓰레드가 인터럽트가 켜진 상태에서 대신 실행한다. */
+
+/* work를 실행할 worker 쓰레드 */
+enum workqueue_id
+{
+	WQ_HIGH,   /* PRI_MAX로 실행 (스케줄러 관련 작업) */
+	WQ_NORMAL, /* PRI_DEFAULT로 실행 */
+	WQ_CNT
+};
+
+typedef void work_func(void *aux);
+
+/* 등록할 일 하나.  등록한 쪽이 소유하며, 실행이 끝날 때까지 유효해야 한다. */
+struct work
+{
+	struct work *next;		/* 대기 중인 work 목록에서 다음 원소 */
+	work_func *func;		/* 실행할 함수 */
+	void *aux;				/* FUNC에 넘길 인자 */
+	volatile bool pending;	/* 등록되어 아직 실행되지 않았으면 true */
+};
+
+void workqueue_init(void);
+void work_init(struct work *, work_func *, void *aux);
+bool work_queue(enum workqueue_id, struct work *);
+void workqueue_print_stats(void);
+
+#endif /* threads/workqueue.h */
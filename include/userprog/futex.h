@@ -0,0 +1,13 @@
+#ifndef USERPROG_FUTEX_H
+#define USERPROG_FUTEX_H
+
+#include <stdbool.h>
+#include "threads/thread.h"
+
+/* NOTE: [Improve] 사용자 메모리 word 위에서 잠들고 깨우는 futex */
+void futex_init(void);
+int futex_wait(int *uaddr, int val);
+int futex_wake(int *uaddr, int cnt);
+void futex_release(struct thread *leader);
+
+#endif /* userprog/futex.h */
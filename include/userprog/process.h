@@ -9,6 +9,12 @@ int process_exec(void *f_name);
 int process_wait(tid_t);
 void process_exit(void);
 void process_activate(struct thread *next);
+void process_print_stats(void);
+
+/* NOTE: [Improve] 같은 주소 공간을 공유하는 사용자 쓰레드 */
+tid_t process_thread_create(void *entry, void *func, void *aux, struct intr_frame *if_);
+int process_thread_join(tid_t tid);
+bool process_single_threaded(void);
 
 /* NOTE: [2.4] 파일 디스크립터 관련 함수 원형 */
 int process_add_file(struct file *f);
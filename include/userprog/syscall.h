@@ -1,8 +1,14 @@
 #ifndef USERPROG_SYSCALL_H
 #define USERPROG_SYSCALL_H
 
+#include <debug.h>
+
 void syscall_init(void);
 
+/* NOTE: [Improve] 여러 쓰레드를 가진 프로세스 전체의 종료 */
+void exit_group(int status) NO_RETURN;
+void exit_group_check(void);
+
 /* NOTE: [2.4] File에 대한 동시 접근을 막기 위한 filesys_lock 추가 */
 struct lock filesys_lock;
 
@@ -1,6 +1,7 @@
 #ifndef VM_FILE_H
 #define VM_FILE_H
 #include "filesys/file.h"
+#include "threads/slab.h"
 #include "vm/vm.h"
 
 struct page;
@@ -13,6 +14,9 @@ struct file_page {
     uint32_t zero_bytes;
 };
 
+/* NOTE: [Improve] lazy load에 넘기는 file_page aux 전용 object cache */
+extern struct slab_cache file_page_cache;
+
 void vm_file_init (void);
 bool file_backed_initializer (struct page *page, enum vm_type type, void *kva);
 void *do_mmap(void *addr, size_t length, int writable,
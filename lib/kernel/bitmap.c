@@ -3,6 +3,7 @@
 #include <limits.h>
 #include <round.h>
 #include <stdio.h>
+#include "threads/interrupt.h"
 #include "threads/malloc.h"
 #ifdef FILESYS
 #include "filesys/file.h"
@@ -23,10 +24,19 @@ typedef unsigned long elem_type;
 
 /* From the outside, a bitmap is an array of bits.  From the
    inside, it's an array of elem_type (defined above) that
-   simulates an array of bits. */
+   simulates an array of bits.
+
+   Searches work an element at a time, using count-trailing-zeros
+   to find the first interesting bit in an element.  A second
+   level, FULL, has one bit per element of BITS that is set when
+   every bit of that element is true, so a search for false bits
+   (the usual case: a free page or sector) skips ELEM_BITS full
+   elements at a time by looking at one element of FULL. */
 struct bitmap {
 	size_t bit_cnt;     /* Number of bits. */
 	elem_type *bits;    /* Elements that represent bits. */
+	elem_type *full;    /* Bit I set iff element I of BITS is full. */
+	size_t hint;        /* Start of the next next-fit search. */
 };
 
 /* Returns the index of the element that contains the bit
@@ -62,6 +72,96 @@ last_mask (const struct bitmap *b) {
 	int last_bits = b->bit_cnt % ELEM_BITS;
 	return last_bits ? ((elem_type) 1 << last_bits) - 1 : (elem_type) -1;
 }
+
+/* Returns the number of bytes required for the FULL summary of
+   a bitmap with BIT_CNT bits. */
+static inline size_t
+full_byte_cnt (size_t bit_cnt) {
+	return byte_cnt (elem_cnt (bit_cnt));
+}
+
+/* Returns a mask of the bits of B's element ELEM that are within
+   the bitmap. */
+static inline elem_type
+used_mask (const struct bitmap *b, size_t elem) {
+	return elem == elem_cnt (b->bit_cnt) - 1 ? last_mask (b) : (elem_type) -1;
+}
+
+/* Returns a mask of the bits of an element from bit START to bit
+   END, exclusive, where 0 <= START < END <= ELEM_BITS. */
+static inline elem_type
+range_mask (size_t start, size_t end) {
+	elem_type mask = (elem_type) -1 << start;
+	if (end < ELEM_BITS)
+		mask &= ((elem_type) 1 << end) - 1;
+	return mask;
+}
+
+/* Returns the index of the lowest set bit in nonzero E. */
+static inline size_t
+lowest_bit (elem_type e) {
+	return __builtin_ctzl (e);
+}
+
+/* Brings the FULL summary bit for B's element ELEM up to date. */
+static inline void
+update_full (struct bitmap *b, size_t elem) {
+	elem_type used = used_mask (b, elem);
+	if ((b->bits[elem] & used) == used)
+		b->full[elem_idx (elem)] |= bit_mask (elem);
+	else
+		b->full[elem_idx (elem)] &= ~bit_mask (elem);
+}
+
+/* Atomically sets the bits in MASK of B's element ELEM to VALUE.
+   Interrupts are turned off so that the element and its summary
+   bit change together. */
+static void
+elem_set (struct bitmap *b, size_t elem, elem_type mask, bool value) {
+	enum intr_level old_level = intr_disable ();
+
+	if (value)
+		asm ("lock orq %1, %0" : "+m" (b->bits[elem]) : "r" (mask) : "cc");
+	else
+		asm ("lock andq %1, %0" : "+m" (b->bits[elem]) : "r" (~mask) : "cc");
+	update_full (b, elem);
+
+	intr_set_level (old_level);
+}
+
+/* Returns the index of the first bit in B from START to END,
+   exclusive, that is set to VALUE, or END if there is none. */
+static size_t
+find_next (const struct bitmap *b, size_t start, size_t end, bool value) {
+	while (start < end) {
+		size_t elem = elem_idx (start);
+		elem_type e;
+
+		if (!value && start % ELEM_BITS == 0) {
+			/* At an element boundary: use the summary to skip
+			   over full elements. */
+			elem_type not_full = ~b->full[elem_idx (elem)]
+				& ((elem_type) -1 << (elem % ELEM_BITS));
+			if (not_full == 0) {
+				start = (elem_idx (elem) + 1) * ELEM_BITS * ELEM_BITS;
+				continue;
+			}
+			elem = elem - elem % ELEM_BITS + lowest_bit (not_full);
+			if (elem * ELEM_BITS >= end)
+				break;
+			start = elem * ELEM_BITS;
+		}
+
+		e = value ? b->bits[elem] : ~b->bits[elem];
+		e &= (elem_type) -1 << (start % ELEM_BITS);
+		if (e != 0) {
+			size_t idx = elem * ELEM_BITS + lowest_bit (e);
+			return idx < end ? idx : end;
+		}
+		start = (elem + 1) * ELEM_BITS;
+	}
+	return end;
+}
 
 /* Creation and destruction. */
 
@@ -74,8 +174,10 @@ bitmap_create (size_t bit_cnt) {
 	struct bitmap *b = malloc (sizeof *b);
 	if (b != NULL) {
 		b->bit_cnt = bit_cnt;
-		b->bits = malloc (byte_cnt (bit_cnt));
+		b->hint = 0;
+		b->bits = malloc (byte_cnt (bit_cnt) + full_byte_cnt (bit_cnt));
 		if (b->bits != NULL || bit_cnt == 0) {
+			b->full = b->bits + elem_cnt (bit_cnt);
 			bitmap_set_all (b, false);
 			return b;
 		}
@@ -94,7 +196,9 @@ bitmap_create_in_buf (size_t bit_cnt, void *block, size_t block_size UNUSED) {
 	ASSERT (block_size >= bitmap_buf_size (bit_cnt));
 
 	b->bit_cnt = bit_cnt;
+	b->hint = 0;
 	b->bits = (elem_type *) (b + 1);
+	b->full = b->bits + elem_cnt (bit_cnt);
 	bitmap_set_all (b, false);
 	return b;
 }
@@ -103,7 +207,7 @@ bitmap_create_in_buf (size_t bit_cnt, void *block, size_t block_size UNUSED) {
    with BIT_CNT bits (for use with bitmap_create_in_buf()). */
 size_t
 bitmap_buf_size (size_t bit_cnt) {
-	return sizeof (struct bitmap) + byte_cnt (bit_cnt);
+	return sizeof (struct bitmap) + byte_cnt (bit_cnt) + full_byte_cnt (bit_cnt);
 }
 
 /* Destroys bitmap B, freeing its storage.
@@ -141,25 +245,19 @@ bitmap_set (struct bitmap *b, size_t idx, bool value) {
 /* Atomically sets the bit numbered BIT_IDX in B to true. */
 void
 bitmap_mark (struct bitmap *b, size_t bit_idx) {
-	size_t idx = elem_idx (bit_idx);
-	elem_type mask = bit_mask (bit_idx);
-
 	/* This is equivalent to `b->bits[idx] |= mask' except that it
 	   is guaranteed to be atomic on a uniprocessor machine.  See
 	   the description of the OR instruction in [IA32-v2b]. */
-	asm ("lock orq %1, %0" : "=m" (b->bits[idx]) : "r" (mask) : "cc");
+	elem_set (b, elem_idx (bit_idx), bit_mask (bit_idx), true);
 }
 
 /* Atomically sets the bit numbered BIT_IDX in B to false. */
 void
 bitmap_reset (struct bitmap *b, size_t bit_idx) {
-	size_t idx = elem_idx (bit_idx);
-	elem_type mask = bit_mask (bit_idx);
-
 	/* This is equivalent to `b->bits[idx] &= ~mask' except that it
 	   is guaranteed to be atomic on a uniprocessor machine.  See
 	   the description of the AND instruction in [IA32-v2a]. */
-	asm ("lock andq %1, %0" : "=m" (b->bits[idx]) : "r" (~mask) : "cc");
+	elem_set (b, elem_idx (bit_idx), bit_mask (bit_idx), false);
 }
 
 /* Atomically toggles the bit numbered IDX in B;
@@ -169,11 +267,15 @@ void
 bitmap_flip (struct bitmap *b, size_t bit_idx) {
 	size_t idx = elem_idx (bit_idx);
 	elem_type mask = bit_mask (bit_idx);
+	enum intr_level old_level = intr_disable ();
 
 	/* This is equivalent to `b->bits[idx] ^= mask' except that it
 	   is guaranteed to be atomic on a uniprocessor machine.  See
 	   the description of the XOR instruction in [IA32-v2b]. */
-	asm ("lock xorq %1, %0" : "=m" (b->bits[idx]) : "r" (mask) : "cc");
+	asm ("lock xorq %1, %0" : "+m" (b->bits[idx]) : "r" (mask) : "cc");
+	update_full (b, idx);
+
+	intr_set_level (old_level);
 }
 
 /* Returns the value of the bit numbered IDX in B. */
@@ -197,47 +299,55 @@ bitmap_set_all (struct bitmap *b, bool value) {
 /* Sets the CNT bits starting at START in B to VALUE. */
 void
 bitmap_set_multiple (struct bitmap *b, size_t start, size_t cnt, bool value) {
-	size_t i;
+	size_t end = start + cnt;
 
 	ASSERT (b != NULL);
 	ASSERT (start <= b->bit_cnt);
 	ASSERT (start + cnt <= b->bit_cnt);
 
-	for (i = 0; i < cnt; i++)
-		bitmap_set (b, start + i, value);
+	/* One element at a time. */
+	while (start < end) {
+		size_t elem = elem_idx (start);
+		size_t elem_end = (elem + 1) * ELEM_BITS < end
+			? ELEM_BITS : end - elem * ELEM_BITS;
+		elem_set (b, elem, range_mask (start % ELEM_BITS, elem_end), value);
+		start = (elem + 1) * ELEM_BITS;
+	}
 }
 
 /* Returns the number of bits in B between START and START + CNT,
    exclusive, that are set to VALUE. */
 size_t
 bitmap_count (const struct bitmap *b, size_t start, size_t cnt, bool value) {
-	size_t i, value_cnt;
+	size_t end = start + cnt;
+	size_t true_cnt = 0;
 
 	ASSERT (b != NULL);
 	ASSERT (start <= b->bit_cnt);
 	ASSERT (start + cnt <= b->bit_cnt);
 
-	value_cnt = 0;
-	for (i = 0; i < cnt; i++)
-		if (bitmap_test (b, start + i) == value)
-			value_cnt++;
-	return value_cnt;
+	/* Count the true bits one element at a time. */
+	while (start < end) {
+		size_t elem = elem_idx (start);
+		size_t elem_end = (elem + 1) * ELEM_BITS < end
+			? ELEM_BITS : end - elem * ELEM_BITS;
+		elem_type e = b->bits[elem] & range_mask (start % ELEM_BITS, elem_end);
+		for (; e != 0; e &= e - 1)
+			true_cnt++;
+		start = (elem + 1) * ELEM_BITS;
+	}
+	return value ? true_cnt : cnt - true_cnt;
 }
 
 /* Returns true if any bits in B between START and START + CNT,
    exclusive, are set to VALUE, and false otherwise. */
 bool
 bitmap_contains (const struct bitmap *b, size_t start, size_t cnt, bool value) {
-	size_t i;
-
 	ASSERT (b != NULL);
 	ASSERT (start <= b->bit_cnt);
 	ASSERT (start + cnt <= b->bit_cnt);
 
-	for (i = 0; i < cnt; i++)
-		if (bitmap_test (b, start + i) == value)
-			return true;
-	return false;
+	return find_next (b, start, start + cnt, value) < start + cnt;
 }
 
 /* Returns true if any bits in B between START and START + CNT,
@@ -272,12 +382,21 @@ bitmap_scan (const struct bitmap *b, size_t start, size_t cnt, bool value) {
 	ASSERT (b != NULL);
 	ASSERT (start <= b->bit_cnt);
 
-	if (cnt <= b->bit_cnt) {
-		size_t last = b->bit_cnt - cnt;
-		size_t i;
-		for (i = start; i <= last; i++)
-			if (!bitmap_contains (b, i, cnt, !value))
-				return i;
+	if (cnt == 0)
+		return start;
+	while (cnt <= b->bit_cnt - start) {
+		/* Find a bit set to VALUE, then see whether the CNT - 1
+		   bits after it are too.  If not, resume after the first
+		   one that is not. */
+		size_t i = find_next (b, start, b->bit_cnt, value);
+		size_t j;
+
+		if (i == b->bit_cnt || cnt > b->bit_cnt - i)
+			break;
+		j = find_next (b, i, i + cnt, !value);
+		if (j == i + cnt)
+			return i;
+		start = j + 1;
 	}
 	return BITMAP_ERROR;
 }
@@ -296,6 +415,27 @@ bitmap_scan_and_flip (struct bitmap *b, size_t start, size_t cnt, bool value) {
 		bitmap_set_multiple (b, idx, cnt, !value);
 	return idx;
 }
+
+/* Next-fit version of bitmap_scan_and_flip(): starts searching
+   where the previous call to this function left off instead of
+   at bit 0, and wraps around to the beginning if nothing is
+   found there.  Spreads allocations across B and avoids
+   rescanning the allocated prefix on every call. */
+size_t
+bitmap_scan_and_flip_next (struct bitmap *b, size_t cnt, bool value) {
+	size_t idx;
+
+	ASSERT (b != NULL);
+
+	idx = bitmap_scan (b, b->hint, cnt, value);
+	if (idx == BITMAP_ERROR && b->hint > 0)
+		idx = bitmap_scan (b, 0, cnt, value);
+	if (idx != BITMAP_ERROR) {
+		bitmap_set_multiple (b, idx, cnt, !value);
+		b->hint = idx + cnt;
+	}
+	return idx;
+}
 
 /* File input and output. */
 
@@ -313,8 +453,11 @@ bitmap_read (struct bitmap *b, struct file *file) {
 	bool success = true;
 	if (b->bit_cnt > 0) {
 		off_t size = byte_cnt (b->bit_cnt);
+		size_t elem;
 		success = file_read_at (file, b->bits, size, 0) == size;
 		b->bits[elem_cnt (b->bit_cnt) - 1] &= last_mask (b);
+		for (elem = 0; elem < elem_cnt (b->bit_cnt); elem++)
+			update_full (b, elem);
 	}
 	return success;
 }
@@ -0,0 +1,299 @@
+#include "rbtree.h"
+#include "../debug.h"
+
+/* A red-black tree is a binary search tree in which every node
+   is colored red or black so that:
+
+   1. The root is black.
+   2. A red node has no red children.
+   3. Every path from a node down to a null leaf passes through
+   the same number of black nodes.
+
+   Together these keep the height within 2 log2 (n + 1), so
+   insertion and removal take O(log n) time.  Null children
+   count as black leaves. */
+
+static void rotate_left (struct rb_tree *, struct rb_node *);
+static void rotate_right (struct rb_tree *, struct rb_node *);
+static void replace_child (struct rb_tree *, struct rb_node *parent,
+		struct rb_node *old, struct rb_node *new);
+static void insert_fixup (struct rb_tree *, struct rb_node *);
+static void remove_fixup (struct rb_tree *, struct rb_node *x,
+		struct rb_node *parent);
+
+static inline bool
+is_red (const struct rb_node *n) {
+	return n != NULL && n->red;
+}
+
+/* Initializes TREE as an empty tree. */
+void
+rb_init (struct rb_tree *tree) {
+	ASSERT (tree != NULL);
+	tree->root = NULL;
+	tree->leftmost = NULL;
+}
+
+/* Returns the smallest node in TREE, or a null pointer if TREE
+   is empty. */
+struct rb_node *
+rb_first (struct rb_tree *tree) {
+	ASSERT (tree != NULL);
+	return tree->leftmost;
+}
+
+/* Returns the node after N in sorted order, or a null pointer
+   if N is the largest node. */
+struct rb_node *
+rb_next (struct rb_node *n) {
+	ASSERT (n != NULL);
+
+	if (n->right != NULL) {
+		n = n->right;
+		while (n->left != NULL)
+			n = n->left;
+		return n;
+	}
+	while (n->parent != NULL && n == n->parent->right)
+		n = n->parent;
+	return n->parent;
+}
+
+/* Returns true if TREE is empty, false otherwise. */
+bool
+rb_empty (struct rb_tree *tree) {
+	ASSERT (tree != NULL);
+	return tree->root == NULL;
+}
+
+/* Inserts NODE into TREE, using LESS given auxiliary data AUX
+   to compare nodes.  NODE is placed after any nodes that
+   compare equal to it. */
+void
+rb_insert (struct rb_tree *tree, struct rb_node *node,
+		rb_less_func *less, void *aux) {
+	struct rb_node *parent = NULL;
+	struct rb_node **link = &tree->root;
+	bool leftmost = true;
+
+	ASSERT (tree != NULL);
+	ASSERT (node != NULL);
+	ASSERT (less != NULL);
+
+	while (*link != NULL) {
+		parent = *link;
+		if (less (node, parent, aux))
+			link = &parent->left;
+		else {
+			link = &parent->right;
+			leftmost = false;
+		}
+	}
+
+	node->parent = parent;
+	node->left = node->right = NULL;
+	node->red = true;
+	*link = node;
+	if (leftmost)
+		tree->leftmost = node;
+
+	insert_fixup (tree, node);
+}
+
+/* Removes NODE, which must be in TREE. */
+void
+rb_remove (struct rb_tree *tree, struct rb_node *node) {
+	struct rb_node *x, *x_parent;
+	bool removed_red;
+
+	ASSERT (tree != NULL);
+	ASSERT (node != NULL);
+
+	if (tree->leftmost == node)
+		tree->leftmost = rb_next (node);
+
+	if (node->left == NULL || node->right == NULL) {
+		/* NODE has at most one child, which takes its place. */
+		x = node->left != NULL ? node->left : node->right;
+		x_parent = node->parent;
+		removed_red = node->red;
+		if (x != NULL)
+			x->parent = x_parent;
+		replace_child (tree, node->parent, node, x);
+	} else {
+		/* NODE has two children.  Its successor Y, which has no
+		   left child, takes NODE's place and color. */
+		struct rb_node *y = node->right;
+		while (y->left != NULL)
+			y = y->left;
+
+		x = y->right;
+		removed_red = y->red;
+		if (y->parent == node)
+			x_parent = y;
+		else {
+			x_parent = y->parent;
+			if (x != NULL)
+				x->parent = x_parent;
+			x_parent->left = x;
+			y->right = node->right;
+			y->right->parent = y;
+		}
+		y->left = node->left;
+		y->left->parent = y;
+		y->parent = node->parent;
+		y->red = node->red;
+		replace_child (tree, node->parent, node, y);
+	}
+
+	if (!removed_red)
+		remove_fixup (tree, x, x_parent);
+}
+
+/* Makes NEW take OLD's place as a child of PARENT, or as the
+   root of TREE if PARENT is null. */
+static void
+replace_child (struct rb_tree *tree, struct rb_node *parent,
+		struct rb_node *old, struct rb_node *new) {
+	if (parent == NULL)
+		tree->root = new;
+	else if (parent->left == old)
+		parent->left = new;
+	else
+		parent->right = new;
+}
+
+/* Rotates the subtree rooted at N to the left. */
+static void
+rotate_left (struct rb_tree *tree, struct rb_node *n) {
+	struct rb_node *r = n->right;
+
+	n->right = r->left;
+	if (r->left != NULL)
+		r->left->parent = n;
+	r->parent = n->parent;
+	replace_child (tree, n->parent, n, r);
+	r->left = n;
+	n->parent = r;
+}
+
+/* Rotates the subtree rooted at N to the right. */
+static void
+rotate_right (struct rb_tree *tree, struct rb_node *n) {
+	struct rb_node *l = n->left;
+
+	n->left = l->right;
+	if (l->right != NULL)
+		l->right->parent = n;
+	l->parent = n->parent;
+	replace_child (tree, n->parent, n, l);
+	l->right = n;
+	n->parent = l;
+}
+
+/* Restores the red-black properties after inserting red node N. */
+static void
+insert_fixup (struct rb_tree *tree, struct rb_node *n) {
+	while (is_red (n->parent)) {
+		struct rb_node *parent = n->parent;
+		struct rb_node *grand = parent->parent;
+
+		if (parent == grand->left) {
+			struct rb_node *uncle = grand->right;
+			if (is_red (uncle)) {
+				parent->red = uncle->red = false;
+				grand->red = true;
+				n = grand;
+				continue;
+			}
+			if (n == parent->right) {
+				rotate_left (tree, parent);
+				n = parent;
+				parent = n->parent;
+			}
+			parent->red = false;
+			grand->red = true;
+			rotate_right (tree, grand);
+		} else {
+			struct rb_node *uncle = grand->left;
+			if (is_red (uncle)) {
+				parent->red = uncle->red = false;
+				grand->red = true;
+				n = grand;
+				continue;
+			}
+			if (n == parent->left) {
+				rotate_right (tree, parent);
+				n = parent;
+				parent = n->parent;
+			}
+			parent->red = false;
+			grand->red = true;
+			rotate_left (tree, grand);
+		}
+	}
+	tree->root->red = false;
+}
+
+/* Restores the red-black properties after removing a black node.
+   X, which may be null, is the node that took its place, and
+   PARENT is X's parent. */
+static void
+remove_fixup (struct rb_tree *tree, struct rb_node *x,
+		struct rb_node *parent) {
+	while (x != tree->root && !is_red (x)) {
+		if (x == parent->left) {
+			struct rb_node *w = parent->right;
+			if (is_red (w)) {
+				w->red = false;
+				parent->red = true;
+				rotate_left (tree, parent);
+				w = parent->right;
+			}
+			if (!is_red (w->left) && !is_red (w->right)) {
+				w->red = true;
+				x = parent;
+				parent = x->parent;
+			} else {
+				if (!is_red (w->right)) {
+					w->left->red = false;
+					w->red = true;
+					rotate_right (tree, w);
+					w = parent->right;
+				}
+				w->red = parent->red;
+				parent->red = false;
+				w->right->red = false;
+				rotate_left (tree, parent);
+				x = tree->root;
+			}
+		} else {
+			struct rb_node *w = parent->left;
+			if (is_red (w)) {
+				w->red = false;
+				parent->red = true;
+				rotate_right (tree, parent);
+				w = parent->left;
+			}
+			if (!is_red (w->left) && !is_red (w->right)) {
+				w->red = true;
+				x = parent;
+				parent = x->parent;
+			} else {
+				if (!is_red (w->left)) {
+					w->right->red = false;
+					w->red = true;
+					rotate_left (tree, w);
+					w = parent->left;
+				}
+				w->red = parent->red;
+				parent->red = false;
+				w->left->red = false;
+				rotate_right (tree, parent);
+				x = tree->root;
+			}
+		}
+	}
+	if (x != NULL)
+		x->red = false;
+}
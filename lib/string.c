@@ -1,5 +1,30 @@
 #include <string.h>
 #include <debug.h>
+#include <stdint.h>
+
+/* The block and string functions below work a machine word (8
+   bytes) at a time instead of a byte at a time, and hand large
+   copies and fills to the "rep movsq" and "rep stosq" string
+   instructions, which the CPU runs in cache-line sized chunks.
+   Both the kernel and user programs are built with little or no
+   optimization, so the compiler will not do this for us.
+
+   Word accesses may be unaligned, which x86-64 allows.  WORD is
+   declared may_alias so that it can read and write memory of any
+   type. */
+typedef uint64_t word __attribute__ ((__may_alias__, __aligned__ (1)));
+#define WORD_SIZE sizeof (word)
+
+/* A word with every byte set to 0x01, and to 0x80. */
+#define ONES ((uint64_t) 0x0101010101010101ULL)
+#define HIGHS ((uint64_t) 0x8080808080808080ULL)
+
+/* Nonzero if some byte of word W is zero. */
+#define HAS_ZERO(W) (((W) - ONES) & ~(W) & HIGHS)
+
+/* Below this many bytes, the start-up cost of the string
+   instructions outweighs their speed. */
+#define REP_THRESHOLD 128
 
 /* Copies SIZE bytes from SRC to DST, which must not overlap.
    Returns DST. */
@@ -11,6 +36,25 @@ memcpy (void *dst_, const void *src_, size_t size) {
 	ASSERT (dst != NULL || size == 0);
 	ASSERT (src != NULL || size == 0);
 
+	if (size >= REP_THRESHOLD) {
+		size_t words;
+
+		/* Align DST, then move whole words with rep movsq. */
+		while ((uintptr_t) dst % WORD_SIZE != 0) {
+			*dst++ = *src++;
+			size--;
+		}
+		words = size / WORD_SIZE;
+		size %= WORD_SIZE;
+		asm volatile ("cld; rep movsq"
+				: "+D" (dst), "+S" (src), "+c" (words) : : "memory");
+	}
+
+	for (; size >= WORD_SIZE; size -= WORD_SIZE) {
+		*(word *) dst = *(const word *) src;
+		dst += WORD_SIZE;
+		src += WORD_SIZE;
+	}
 	while (size-- > 0)
 		*dst++ = *src++;
 
@@ -27,17 +71,23 @@ memmove (void *dst_, const void *src_, size_t size) {
 	ASSERT (dst != NULL || size == 0);
 	ASSERT (src != NULL || size == 0);
 
-	if (dst < src) {
-		while (size-- > 0)
-			*dst++ = *src++;
-	} else {
-		dst += size;
-		src += size;
-		while (size-- > 0)
-			*--dst = *--src;
+	/* A forward copy is safe unless DST starts inside SRC. */
+	if (dst <= src || dst >= src + size)
+		return memcpy (dst_, src_, size);
+
+	/* Copy backward, last word first.  Each word is read before
+	   any write can reach it. */
+	dst += size;
+	src += size;
+	for (; size >= WORD_SIZE; size -= WORD_SIZE) {
+		dst -= WORD_SIZE;
+		src -= WORD_SIZE;
+		*(word *) dst = *(const word *) src;
 	}
+	while (size-- > 0)
+		*--dst = *--src;
 
-	return dst;
+	return dst_;
 }
 
 /* Find the first differing byte in the two blocks of SIZE bytes
@@ -52,6 +102,13 @@ memcmp (const void *a_, const void *b_, size_t size) {
 	ASSERT (a != NULL || size == 0);
 	ASSERT (b != NULL || size == 0);
 
+	/* Skip over equal words; the byte loop finds the difference. */
+	for (; size >= WORD_SIZE; size -= WORD_SIZE) {
+		if (*(const word *) a != *(const word *) b)
+			break;
+		a += WORD_SIZE;
+		b += WORD_SIZE;
+	}
 	for (; size-- > 0; a++, b++)
 		if (*a != *b)
 			return *a > *b ? +1 : -1;
@@ -257,9 +314,28 @@ strtok_r (char *s, const char *delimiters, char **save_ptr) {
 void *
 memset (void *dst_, int value, size_t size) {
 	unsigned char *dst = dst_;
+	uint64_t pattern = (unsigned char) value * ONES;
 
 	ASSERT (dst != NULL || size == 0);
 
+	if (size >= REP_THRESHOLD) {
+		size_t words;
+
+		/* Align DST, then store whole words with rep stosq. */
+		while ((uintptr_t) dst % WORD_SIZE != 0) {
+			*dst++ = value;
+			size--;
+		}
+		words = size / WORD_SIZE;
+		size %= WORD_SIZE;
+		asm volatile ("cld; rep stosq"
+				: "+D" (dst), "+c" (words) : "a" (pattern) : "memory");
+	}
+
+	for (; size >= WORD_SIZE; size -= WORD_SIZE) {
+		*(word *) dst = pattern;
+		dst += WORD_SIZE;
+	}
 	while (size-- > 0)
 		*dst++ = value;
 
@@ -273,8 +349,16 @@ strlen (const char *string) {
 
 	ASSERT (string);
 
-	for (p = string; *p != '\0'; p++)
-		continue;
+	/* Check bytes up to a word boundary, then whole aligned words.
+	   An aligned word never crosses a page boundary, so reading
+	   past the terminator within it is safe. */
+	for (p = string; (uintptr_t) p % WORD_SIZE != 0; p++)
+		if (*p == '\0')
+			return p - string;
+	while (!HAS_ZERO (*(const word *) p))
+		p += WORD_SIZE;
+	while (*p != '\0')
+		p++;
 	return p - string;
 }
 
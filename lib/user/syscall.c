@@ -194,3 +194,36 @@ int
 umount (const char *path) {
 	return syscall1 (SYS_UMOUNT, path);
 }
+
+int
+getrusage (int who, struct rusage *usage) {
+	return syscall2 (SYS_GETRUSAGE, who, usage);
+}
+
+/* Runs FUNC(AUX) in a thread created by uthread_create() and ends
+   the thread when FUNC returns. */
+static void
+uthread_start (uthread_func *func, void *aux) {
+	func (aux);
+	uthread_exit (0);
+}
+
+uthread_t
+uthread_create (uthread_func *func, void *aux) {
+	return syscall3 (SYS_THREAD_CREATE, uthread_start, func, aux);
+}
+
+int
+uthread_join (uthread_t tid) {
+	return syscall1 (SYS_THREAD_JOIN, tid);
+}
+
+void
+uthread_exit (int status) {
+	exit (status);
+}
+
+int
+futex (int *uaddr, int op, int val) {
+	return syscall3 (SYS_FUTEX, uaddr, op, val);
+}
@@ -0,0 +1,76 @@
+#include <usynch.h>
+#include <limits.h>
+#include <syscall.h>
+
+/* Mutexes follow the three-state design from Drepper, "Futexes Are
+   Tricky": the state records whether anyone may be sleeping, so
+   release only calls FUTEX_WAKE when there can be a waiter. */
+
+void
+umutex_init (struct umutex *m) {
+	m->state = 0;
+}
+
+/* Sets M's state to 2 (held, maybe contended) and sleeps until the
+   previous state was free. */
+static void
+umutex_acquire_contended (struct umutex *m) {
+	while (__atomic_exchange_n (&m->state, 2, __ATOMIC_ACQUIRE) != 0)
+		futex (&m->state, FUTEX_WAIT, 2);
+}
+
+void
+umutex_acquire (struct umutex *m) {
+	int expected = 0;
+
+	if (!__atomic_compare_exchange_n (&m->state, &expected, 1, false,
+				__ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		umutex_acquire_contended (m);
+}
+
+bool
+umutex_try_acquire (struct umutex *m) {
+	int expected = 0;
+
+	return __atomic_compare_exchange_n (&m->state, &expected, 1, false,
+			__ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+void
+umutex_release (struct umutex *m) {
+	if (__atomic_fetch_sub (&m->state, 1, __ATOMIC_RELEASE) != 1) {
+		__atomic_store_n (&m->state, 0, __ATOMIC_RELEASE);
+		futex (&m->state, FUTEX_WAKE, 1);
+	}
+}
+
+void
+ucond_init (struct ucond *c) {
+	c->seq = 0;
+}
+
+/* Atomically releases M and waits for C to be signaled, then
+   reacquires M.  As with the kernel's condition variables the
+   caller must recheck its condition after waking up. */
+void
+ucond_wait (struct ucond *c, struct umutex *m) {
+	int seq = __atomic_load_n (&c->seq, __ATOMIC_ACQUIRE);
+
+	umutex_release (m);
+	futex (&c->seq, FUTEX_WAIT, seq);
+	/* Other threads may be sleeping on M, so take it in the
+	   contended state to make sure they are woken later. */
+	umutex_acquire_contended (m);
+}
+
+void
+ucond_signal (struct ucond *c) {
+	__atomic_fetch_add (&c->seq, 1, __ATOMIC_RELEASE);
+	futex (&c->seq, FUTEX_WAKE, 1);
+}
+
+void
+ucond_broadcast (struct ucond *c) {
+	__atomic_fetch_add (&c->seq, 1, __ATOMIC_RELEASE);
+	futex (&c->seq, FUTEX_WAKE, INT_MAX);
+}
@@ -0,0 +1,262 @@
+/* Checks the word-at-a-time bitmap searches in lib/kernel/bitmap.c.
+
+   bitmap_scan() is compared against a bit-by-bit reference over
+   a grid of start positions and run lengths, on a bitmap that is
+   long enough for the FULL summary to span several elements and
+   whose last element is only partly used.  Then bitmap_read()
+   must rebuild the summary of a bitmap that it overwrites, and
+   bitmap_scan_and_flip_next() must wrap around to the start of
+   the bitmap when nothing fits after its hint. */
+
+#include <bitmap.h>
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#ifdef FILESYS
+#include "filesys/file.h"
+#include "filesys/filesys.h"
+#endif
+
+/* Bits per element of the bitmap and of its summary. */
+#define ELEM_BITS 64
+
+/* Two summary elements' worth of full elements, plus a partial
+   last element of 37 bits. */
+#define BIT_CNT (2 * ELEM_BITS * ELEM_BITS + 37)
+
+/* Returns the start of the first run of CNT bits set to VALUE in
+   B at or after START, one bit at a time. */
+static size_t
+ref_scan (const struct bitmap *b, size_t start, size_t cnt, bool value)
+{
+  size_t i, run = 0;
+
+  if (cnt == 0)
+    return start;
+  for (i = start; i < bitmap_size (b); i++)
+    {
+      run = bitmap_test (b, i) == value ? run + 1 : 0;
+      if (run == cnt)
+        return i + 1 - cnt;
+    }
+  return BITMAP_ERROR;
+}
+
+/* Ranges flipped away from the fill value, as {start, cnt}
+   pairs terminated by a zero count. */
+static const size_t patterns[][5][2] =
+  {
+    /* Every element full. */
+    {{0, 0}},
+    /* One hole past a whole summary element of full elements. */
+    {{4100, 1}, {0, 0}},
+    /* A hole across the boundary of two summary elements. */
+    {{8190, 5}, {0, 0}},
+    /* Holes at element boundaries and in the last bit. */
+    {{63, 2}, {4095, 3}, {BIT_CNT - 1, 1}, {0, 0}},
+    /* Short holes before a run longer than an element. */
+    {{100, 1}, {2000, 2}, {5000, 4}, {8000, 70}, {0, 0}},
+    /* The whole partial last element. */
+    {{2 * ELEM_BITS * ELEM_BITS, 37}, {0, 0}},
+  };
+
+/* bitmap_scan() against ref_scan() for every pattern, filled
+   both ways. */
+static void
+test_scan (void)
+{
+  static const size_t starts[] = {0, 1, 63, 64, 4095, 4096, 4100, 8191,
+                                  8192, BIT_CNT - 1, BIT_CNT};
+  static const size_t cnts[] = {1, 2, 3, 5, 37, 64, 65, 70};
+  struct bitmap *b = bitmap_create (BIT_CNT);
+  size_t p, h, s, c;
+  int fill;
+
+  if (b == NULL)
+    fail ("bitmap_create failed");
+
+  for (p = 0; p < sizeof patterns / sizeof *patterns; p++)
+    for (fill = 0; fill < 2; fill++)
+      {
+        bitmap_set_all (b, fill);
+        for (h = 0; patterns[p][h][1] != 0; h++)
+          bitmap_set_multiple (b, patterns[p][h][0], patterns[p][h][1], !fill);
+
+        for (s = 0; s < sizeof starts / sizeof *starts; s++)
+          for (c = 0; c < sizeof cnts / sizeof *cnts; c++)
+            {
+              size_t expected = ref_scan (b, starts[s], cnts[c], !fill);
+              size_t actual = bitmap_scan (b, starts[s], cnts[c], !fill);
+              if (actual != expected)
+                fail ("pattern %zu filled with %d: bitmap_scan from %zu for "
+                      "%zu bits returned %zu, expected %zu",
+                      p, fill, starts[s], cnts[c], actual, expected);
+            }
+      }
+  bitmap_destroy (b);
+  msg ("bitmap_scan: runs across full elements OK.");
+}
+
+/* A partly used last element counts as full once its used bits
+   are, and runs may end on its last bit but not past it. */
+static void
+test_partial (void)
+{
+  static const size_t sizes[] = {1, 37, ELEM_BITS + 37, BIT_CNT};
+  size_t i;
+
+  for (i = 0; i < sizeof sizes / sizeof *sizes; i++)
+    {
+      size_t n = sizes[i];
+      struct bitmap *b = bitmap_create (n);
+
+      if (b == NULL)
+        fail ("bitmap_create failed");
+
+      bitmap_set_all (b, true);
+      if (!bitmap_all (b, 0, n) || bitmap_scan (b, 0, 1, false) != BITMAP_ERROR)
+        fail ("%zu-bit bitmap with every bit set has a false bit", n);
+
+      bitmap_reset (b, n - 1);
+      if (bitmap_scan (b, 0, 1, false) != n - 1)
+        fail ("%zu-bit bitmap: last bit not found", n);
+      if (n > 1 && bitmap_scan (b, 0, 2, false) != BITMAP_ERROR)
+        fail ("%zu-bit bitmap: 2-bit run found past the end", n);
+
+      if (n > 1)
+        {
+          bitmap_reset (b, n - 2);
+          if (bitmap_scan (b, 0, 2, false) != n - 2)
+            fail ("%zu-bit bitmap: 2-bit run at the end not found", n);
+        }
+
+      bitmap_set_all (b, false);
+      bitmap_mark (b, n - 1);
+      if (bitmap_scan (b, 0, 1, true) != n - 1
+          || bitmap_scan (b, 0, n, false) != BITMAP_ERROR)
+        fail ("%zu-bit bitmap: wrong result with only the last bit set", n);
+
+      bitmap_destroy (b);
+    }
+  msg ("bitmap_scan: partial last element OK.");
+}
+
+/* bitmap_read() into a bitmap whose summary says every element
+   is full must leave the holes in the file findable. */
+static void
+test_read (void)
+{
+#ifdef FILESYS
+  static unsigned long raw[(BIT_CNT + ELEM_BITS - 1) / ELEM_BITS];
+  static const size_t holes[] = {4100, 8200, BIT_CNT - 1};
+  struct bitmap *b = bitmap_create (BIT_CNT);
+  struct file *file;
+  off_t size;
+  size_t i, idx;
+
+  if (b == NULL)
+    fail ("bitmap_create failed");
+  size = bitmap_file_size (b);
+  if (size != sizeof raw)
+    fail ("bitmap_file_size returned %d, expected %zu", size, sizeof raw);
+
+  /* Every bit set, including the unused ones at the end. */
+  memset (raw, 0xff, sizeof raw);
+  for (i = 0; i < sizeof holes / sizeof *holes; i++)
+    raw[holes[i] / ELEM_BITS] &= ~(1ul << holes[i] % ELEM_BITS);
+
+  if (!filesys_create ("bitmap", size))
+    fail ("filesys_create failed");
+  file = filesys_open ("bitmap");
+  if (file == NULL)
+    fail ("filesys_open failed");
+  if (file_write_at (file, raw, size, 0) != size)
+    fail ("file_write_at failed");
+
+  bitmap_set_all (b, true);
+  if (!bitmap_read (b, file))
+    fail ("bitmap_read failed");
+  file_close (file);
+  filesys_remove ("bitmap");
+
+  idx = 0;
+  for (i = 0; i < sizeof holes / sizeof *holes; i++)
+    {
+      idx = bitmap_scan (b, idx, 1, false);
+      if (idx != holes[i])
+        fail ("after bitmap_read, false bit %zu found at %zu, expected %zu",
+              i, idx, holes[i]);
+      idx++;
+    }
+  if (bitmap_count (b, 0, BIT_CNT, true) != BIT_CNT - 3)
+    fail ("after bitmap_read, %zu bits set, expected %zu",
+          bitmap_count (b, 0, BIT_CNT, true), (size_t) BIT_CNT - 3);
+
+  bitmap_destroy (b);
+  msg ("bitmap_read: summary rebuilt OK.");
+#else
+  msg ("bitmap_read: skipped, no file system.");
+#endif
+}
+
+/* Calls bitmap_scan_and_flip_next() on B for CNT false bits and
+   fails unless it returns EXPECTED. */
+static void
+expect_next (struct bitmap *b, size_t cnt, size_t expected)
+{
+  size_t idx = bitmap_scan_and_flip_next (b, cnt, false);
+  if (idx != expected)
+    fail ("bitmap_scan_and_flip_next for %zu bits returned %zu, "
+          "expected %zu", cnt, idx, expected);
+}
+
+/* bitmap_scan_and_flip_next() continues from where it left off
+   and wraps around only when nothing fits after that. */
+static void
+test_next_fit (void)
+{
+  struct bitmap *b = bitmap_create (200);
+
+  if (b == NULL)
+    fail ("bitmap_create failed");
+
+  /* Fills the bitmap in order, then finds it full. */
+  expect_next (b, 50, 0);
+  expect_next (b, 50, 50);
+  expect_next (b, 50, 100);
+  expect_next (b, 50, 150);
+  expect_next (b, 1, BITMAP_ERROR);
+
+  /* With the hint at the end, wraps to the first hole; then
+     continues after it rather than starting over. */
+  bitmap_set_multiple (b, 0, 50, false);
+  bitmap_set_multiple (b, 100, 50, false);
+  expect_next (b, 50, 0);
+  expect_next (b, 10, 100);
+
+  /* Holes at 10, 110 and 180.  A request too big for any of
+     them fails without moving the hint.  A request that fits
+     only before the hint wraps around to find it. */
+  bitmap_set_multiple (b, 180, 20, false);
+  bitmap_set_multiple (b, 10, 30, false);
+  expect_next (b, 45, BITMAP_ERROR);
+  expect_next (b, 25, 110);
+  expect_next (b, 30, 10);
+  expect_next (b, 15, 135);
+  expect_next (b, 20, 180);
+  expect_next (b, 1, BITMAP_ERROR);
+
+  bitmap_destroy (b);
+  msg ("bitmap_scan_and_flip_next: wraparound OK.");
+}
+
+void
+test_bitmap_scan (void)
+{
+  test_scan ();
+  test_partial ();
+  test_read ();
+  test_next_fit ();
+}
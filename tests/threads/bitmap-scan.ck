@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF', <<'EOF']);
+(bitmap-scan) begin
+(bitmap-scan) bitmap_scan: runs across full elements OK.
+(bitmap-scan) bitmap_scan: partial last element OK.
+(bitmap-scan) bitmap_read: summary rebuilt OK.
+(bitmap-scan) bitmap_scan_and_flip_next: wraparound OK.
+(bitmap-scan) end
+EOF
+(bitmap-scan) begin
+(bitmap-scan) bitmap_scan: runs across full elements OK.
+(bitmap-scan) bitmap_scan: partial last element OK.
+(bitmap-scan) bitmap_read: skipped, no file system.
+(bitmap-scan) bitmap_scan_and_flip_next: wraparound OK.
+(bitmap-scan) end
+EOF
+pass;
@@ -0,0 +1,68 @@
+/* Measures the cost of a kernel-to-kernel thread switch.
+
+   The main thread and a helper thread of the same priority hand
+   control back and forth through a pair of semaphores, so every
+   round trip is two thread switches.  The average number of TSC
+   cycles per switch is printed so that kernels can be compared;
+   the test itself only checks that every round trip completes. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define ROUND_CNT 10000
+
+struct pingpong 
+  {
+    struct semaphore ping;      /* Upped by the main thread. */
+    struct semaphore pong;      /* Upped by the helper thread. */
+  };
+
+static thread_func pong_thread;
+
+void
+test_ctxsw_bench (void) 
+{
+  struct pingpong pp;
+  uint64_t start, cycles;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&pp.ping, 0);
+  sema_init (&pp.pong, 0);
+  thread_create ("pong", PRI_DEFAULT, pong_thread, &pp);
+
+  /* One untimed round trip so the helper is already waiting. */
+  sema_up (&pp.ping);
+  sema_down (&pp.pong);
+
+  start = rdtsc ();
+  for (i = 0; i < ROUND_CNT; i++) 
+    {
+      sema_up (&pp.ping);
+      sema_down (&pp.pong);
+    }
+  cycles = rdtsc () - start;
+
+  msg ("%d round trips, %llu cycles per switch",
+       ROUND_CNT, cycles / (2 * ROUND_CNT));
+  pass ();
+}
+
+static void
+pong_thread (void *pp_) 
+{
+  struct pingpong *pp = pp_;
+  int i;
+
+  for (i = 0; i <= ROUND_CNT; i++) 
+    {
+      sema_down (&pp->ping);
+      sema_up (&pp->pong);
+    }
+}
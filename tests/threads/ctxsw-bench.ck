@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+@output = get_core_output ("run", @output);
+fail "missing round trip timing in output"
+  unless grep (/^\(ctxsw-bench\) 10000 round trips, \d+ cycles per switch$/,
+	       @output);
+fail "missing PASS in output"
+  unless grep ($_ eq '(ctxsw-bench) PASS', @output);
+
+pass;
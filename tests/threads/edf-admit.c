@@ -0,0 +1,60 @@
+/* Checks admission control of the EDF class.  Bad parameters are
+   rejected, and a thread is admitted only while the total
+   utilization (runtime / deadline) of all EDF threads stays within
+   95%. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func other_thread;
+static struct semaphore done;
+
+void
+test_edf_admit (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  if (thread_set_edf (0, 100, 100))
+    fail ("zero runtime admitted");
+  if (thread_set_edf (60, 100, 50))
+    fail ("runtime longer than deadline admitted");
+  if (thread_set_edf (10, 50, 100))
+    fail ("deadline longer than period admitted");
+  msg ("Bad parameters rejected.");
+
+  if (!thread_set_edf (500, 1000, 1000))
+    fail ("main thread not admitted at 50%%");
+  msg ("Main thread admitted at 50%%.");
+
+  sema_init (&done, 0);
+  thread_create ("other", PRI_DEFAULT, other_thread, NULL);
+  sema_down (&done);
+
+  /* Changing our own parameters does not count our old share. */
+  if (!thread_set_edf (450, 1000, 500))
+    fail ("main thread not re-admitted at 90%%");
+  msg ("Main thread re-admitted at 90%%.");
+
+  thread_clear_edf ();
+  if (!thread_set_edf (950, 1000, 1000))
+    fail ("main thread not admitted at 95%% after leaving EDF");
+  msg ("Main thread admitted at 95%% after leaving EDF.");
+  thread_clear_edf ();
+}
+
+static void
+other_thread (void *aux UNUSED) 
+{
+  if (thread_set_edf (500, 1000, 1000))
+    fail ("other thread admitted at 50%% on top of 50%%");
+  msg ("Other thread rejected at 50%%.");
+  if (!thread_set_edf (450, 1000, 1000))
+    fail ("other thread not admitted at 45%% on top of 50%%");
+  msg ("Other thread admitted at 45%%.");
+  thread_clear_edf ();
+  sema_up (&done);
+}
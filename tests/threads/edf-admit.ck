@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-admit) begin
+(edf-admit) Bad parameters rejected.
+(edf-admit) Main thread admitted at 50%.
+(edf-admit) Other thread rejected at 50%.
+(edf-admit) Other thread admitted at 45%.
+(edf-admit) Main thread re-admitted at 90%.
+(edf-admit) Main thread admitted at 95% after leaving EDF.
+(edf-admit) end
+EOF
+pass;
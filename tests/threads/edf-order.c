@@ -0,0 +1,69 @@
+/* Checks that EDF threads run in order of their absolute deadlines,
+   and all of them before any thread of the priority scheduler,
+   even one at PRI_MAX. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func edf_thread, normal_thread;
+static struct semaphore ready, start, done;
+
+void
+test_edf_order (void) 
+{
+  static const int deadlines[] = {500, 300, 400};
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&ready, 0);
+  sema_init (&start, 0);
+  sema_init (&done, 0);
+
+  /* Run as an EDF thread with the earliest deadline, so that none
+     of the threads we create or wake up runs before we block. */
+  if (!thread_set_edf (100, 1000, 200))
+    fail ("main thread not admitted");
+
+  for (i = 0; i < 3; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "edf %d", deadlines[i]);
+      thread_create (name, PRI_DEFAULT, edf_thread,
+                     (void *) (intptr_t) deadlines[i]);
+      sema_down (&ready);
+    }
+  thread_create ("normal", PRI_MAX, normal_thread, NULL);
+
+  for (i = 0; i < 3; i++)
+    sema_up (&start);
+  msg ("Main thread blocking.");
+  for (i = 0; i < 4; i++)
+    sema_down (&done);
+  thread_clear_edf ();
+}
+
+static void
+edf_thread (void *deadline_) 
+{
+  int deadline = (intptr_t) deadline_;
+
+  if (!thread_set_edf (50, 1000, deadline))
+    fail ("thread %s not admitted", thread_name ());
+  sema_up (&ready);
+  sema_down (&start);
+  msg ("Thread %s running.", thread_name ());
+  sema_up (&done);
+}
+
+static void
+normal_thread (void *aux UNUSED) 
+{
+  msg ("Thread normal running.");
+  sema_up (&done);
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-order) begin
+(edf-order) Main thread blocking.
+(edf-order) Thread edf 300 running.
+(edf-order) Thread edf 400 running.
+(edf-order) Thread edf 500 running.
+(edf-order) Thread normal running.
+(edf-order) end
+EOF
+pass;
@@ -0,0 +1,78 @@
+/* An EDF thread that asks for RUNTIME ticks every PERIOD ticks
+   spins for PERIOD_CNT periods.  It must be throttled once it has
+   used its runtime, get its runtime back at the start of every
+   period, and leave the rest of the CPU to other threads. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define RUNTIME 2
+#define PERIOD 10
+#define PERIOD_CNT 10
+
+static thread_func edf_thread;
+static volatile bool edf_done;
+static int edf_ticks, edf_periods;
+
+void
+test_edf_throttle (void) 
+{
+  int64_t last = -1;
+  int main_ticks = 0;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  thread_create ("edf", PRI_DEFAULT + 1, edf_thread, NULL);
+
+  /* Count the ticks we get while the EDF thread is throttled. */
+  while (!edf_done) 
+    {
+      int64_t now = timer_ticks ();
+      if (now != last) 
+        {
+          last = now;
+          main_ticks++;
+        }
+    }
+
+  if (edf_ticks > PERIOD_CNT * (RUNTIME + 1))
+    fail ("EDF thread ran %d ticks, at most %d expected",
+          edf_ticks, PERIOD_CNT * (RUNTIME + 1));
+  msg ("EDF thread was throttled after its runtime.");
+
+  if (edf_periods < PERIOD_CNT - 1)
+    fail ("EDF thread ran in only %d of %d periods", edf_periods, PERIOD_CNT);
+  msg ("EDF thread's runtime was replenished every period.");
+
+  if (main_ticks < PERIOD_CNT * (PERIOD - RUNTIME) / 2)
+    fail ("main thread got only %d ticks", main_ticks);
+  msg ("Main thread ran while the EDF thread was throttled.");
+}
+
+static void
+edf_thread (void *aux UNUSED) 
+{
+  bool seen[PERIOD_CNT] = {false};
+  int64_t start, now, last = -1;
+  int i;
+
+  if (!thread_set_edf (RUNTIME, PERIOD, PERIOD))
+    fail ("EDF thread not admitted");
+
+  start = timer_ticks ();
+  while ((now = timer_ticks ()) < start + PERIOD * PERIOD_CNT)
+    if (now != last) 
+      {
+        last = now;
+        edf_ticks++;
+        seen[(now - start) / PERIOD] = true;
+      }
+
+  for (i = 0; i < PERIOD_CNT; i++)
+    edf_periods += seen[i];
+  edf_done = true;
+}
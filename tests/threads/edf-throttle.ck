@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-throttle) begin
+(edf-throttle) EDF thread was throttled after its runtime.
+(edf-throttle) EDF thread's runtime was replenished every period.
+(edf-throttle) Main thread ran while the EDF thread was throttled.
+(edf-throttle) end
+EOF
+pass;
@@ -0,0 +1,81 @@
+/* Measures malloc()/free() throughput with many concurrent
+   kernel threads.
+
+   THREAD_CNT threads of the same priority each allocate a batch
+   of blocks of mixed sizes, fill them, check them and free them
+   again, ROUND_CNT times, while timer preemption interleaves
+   them.  The average number of TSC cycles per malloc/free pair
+   is printed so that kernels can be compared; the test itself
+   only checks that no block was handed out twice. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define THREAD_CNT 16
+#define ROUND_CNT 500
+#define BATCH_CNT 8
+
+static struct semaphore done;
+static thread_func bench_thread;
+
+void
+test_malloc_bench (void) 
+{
+  uint64_t start, cycles;
+  long long pairs = (long long) THREAD_CNT * ROUND_CNT * BATCH_CNT;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done, 0);
+  start = rdtsc ();
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "bench %d", i);
+      thread_create (name, PRI_DEFAULT, bench_thread, (void *) (uintptr_t) i);
+    }
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&done);
+  cycles = rdtsc () - start;
+
+  msg ("%d threads, %lld malloc/free pairs, %llu cycles per pair",
+       THREAD_CNT, pairs, cycles / pairs);
+  pass ();
+}
+
+static void
+bench_thread (void *id_) 
+{
+  int id = (uintptr_t) id_;
+  unsigned char *blocks[BATCH_CNT];
+  int round, i;
+
+  for (round = 0; round < ROUND_CNT; round++) 
+    {
+      for (i = 0; i < BATCH_CNT; i++) 
+        {
+          size_t size = 16 << ((round + i) % 7);
+          blocks[i] = malloc (size);
+          if (blocks[i] == NULL)
+            fail ("thread %d: malloc(%zu) failed", id, size);
+          memset (blocks[i], id + i, size);
+        }
+      for (i = 0; i < BATCH_CNT; i++) 
+        {
+          size_t size = 16 << ((round + i) % 7);
+          if (blocks[i][0] != (unsigned char) (id + i)
+              || blocks[i][size - 1] != (unsigned char) (id + i))
+            fail ("thread %d: block %d was overwritten", id, i);
+          free (blocks[i]);
+        }
+    }
+  sema_up (&done);
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+@output = get_core_output ("run", @output);
+fail "missing throughput in output"
+  unless grep (/^\(malloc-bench\) 16 threads, 64000 malloc\/free pairs, \d+ cycles per pair$/,
+	       @output);
+fail "missing PASS in output"
+  unless grep ($_ eq '(malloc-bench) PASS', @output);
+
+pass;
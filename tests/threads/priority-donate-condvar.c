@@ -0,0 +1,74 @@
+/* A thread that waits on a condition variable while it holds a
+   donated priority loses the donation when cond_wait() releases
+   the lock.  cond_signal() must then rank it by its own, lower
+   priority rather than by the priority it had when it started
+   waiting.
+
+   The "low" thread starts waiting at priority PRI_DEFAULT + 10
+   (donated by "high") and drops to PRI_DEFAULT + 1.  The "mid"
+   thread waits at PRI_DEFAULT + 5, so it must be woken first. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func low_thread, mid_thread, high_thread;
+static struct lock lock;
+static struct condition condition;
+
+void
+test_priority_donate_condvar (void) 
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  lock_init (&lock);
+  cond_init (&condition);
+
+  thread_create ("low", PRI_DEFAULT + 1, low_thread, NULL);
+  thread_create ("mid", PRI_DEFAULT + 5, mid_thread, NULL);
+
+  for (i = 0; i < 2; i++) 
+    {
+      lock_acquire (&lock);
+      msg ("Signaling...");
+      cond_signal (&condition, &lock);
+      lock_release (&lock);
+    }
+}
+
+static void
+low_thread (void *aux UNUSED) 
+{
+  lock_acquire (&lock);
+  thread_create ("high", PRI_DEFAULT + 10, high_thread, NULL);
+  msg ("Thread low waiting with priority %d.", thread_get_priority ());
+  cond_wait (&condition, &lock);
+  msg ("Thread low woke up with priority %d.", thread_get_priority ());
+  lock_release (&lock);
+}
+
+static void
+mid_thread (void *aux UNUSED) 
+{
+  lock_acquire (&lock);
+  msg ("Thread mid waiting with priority %d.", thread_get_priority ());
+  cond_wait (&condition, &lock);
+  msg ("Thread mid woke up with priority %d.", thread_get_priority ());
+  lock_release (&lock);
+}
+
+static void
+high_thread (void *aux UNUSED) 
+{
+  lock_acquire (&lock);
+  msg ("Thread high got the lock.");
+  lock_release (&lock);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-donate-condvar) begin
+(priority-donate-condvar) Thread low waiting with priority 41.
+(priority-donate-condvar) Thread high got the lock.
+(priority-donate-condvar) Thread mid waiting with priority 36.
+(priority-donate-condvar) Signaling...
+(priority-donate-condvar) Thread mid woke up with priority 36.
+(priority-donate-condvar) Signaling...
+(priority-donate-condvar) Thread low woke up with priority 32.
+(priority-donate-condvar) end
+EOF
+pass;
@@ -0,0 +1,83 @@
+/* The main thread and a "reader" thread both hold a reader-writer
+   lock for reading.  A higher-priority "writer" thread then
+   blocks acquiring it for writing, and an even higher-priority
+   "reader2" thread blocks acquiring it for reading because a
+   writer is waiting.  Every reader holding the lock should
+   receive the donated priority.  When the readers release the
+   lock, the writer should get it before reader2. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+struct rwlock_test
+  {
+    struct rwlock rwlock;
+    struct semaphore sema;
+  };
+
+static thread_func reader_thread_func;
+static thread_func writer_thread_func;
+static thread_func reader2_thread_func;
+
+void
+test_priority_donate_rwlock (void) 
+{
+  struct rwlock_test t;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&t.rwlock);
+  sema_init (&t.sema, 0);
+  rwlock_acquire_read (&t.rwlock);
+  thread_create ("reader", PRI_DEFAULT + 1, reader_thread_func, &t);
+  thread_create ("writer", PRI_DEFAULT + 3, writer_thread_func, &t);
+  thread_create ("reader2", PRI_DEFAULT + 4, reader2_thread_func, &t);
+  msg ("main should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 4, thread_get_priority ());
+  rwlock_release_read (&t.rwlock);
+  sema_up (&t.sema);
+  msg ("reader, writer, reader2 must already have finished.");
+}
+
+static void
+reader_thread_func (void *t_) 
+{
+  struct rwlock_test *t = t_;
+
+  rwlock_acquire_read (&t->rwlock);
+  msg ("reader: got the read lock");
+  sema_down (&t->sema);
+  msg ("reader should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 4, thread_get_priority ());
+  rwlock_release_read (&t->rwlock);
+  msg ("reader: done");
+}
+
+static void
+writer_thread_func (void *t_) 
+{
+  struct rwlock_test *t = t_;
+
+  rwlock_acquire_write (&t->rwlock);
+  msg ("writer: got the write lock");
+  rwlock_release_write (&t->rwlock);
+  msg ("writer: done");
+}
+
+static void
+reader2_thread_func (void *t_) 
+{
+  struct rwlock_test *t = t_;
+
+  rwlock_acquire_read (&t->rwlock);
+  msg ("reader2: got the read lock");
+  rwlock_release_read (&t->rwlock);
+  msg ("reader2: done");
+}
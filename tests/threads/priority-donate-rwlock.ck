@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-donate-rwlock) begin
+(priority-donate-rwlock) reader: got the read lock
+(priority-donate-rwlock) main should have priority 35.  Actual priority: 35.
+(priority-donate-rwlock) reader should have priority 35.  Actual priority: 35.
+(priority-donate-rwlock) writer: got the write lock
+(priority-donate-rwlock) reader2: got the read lock
+(priority-donate-rwlock) reader2: done
+(priority-donate-rwlock) writer: done
+(priority-donate-rwlock) reader: done
+(priority-donate-rwlock) reader, writer, reader2 must already have finished.
+(priority-donate-rwlock) end
+EOF
+pass;
@@ -0,0 +1,58 @@
+/* The main thread holds a reader-writer lock for writing while
+   two writers and two higher-priority readers block on it.
+   Waiting writers are preferred over waiting readers, so when
+   the lock is released the writers should get it first, in
+   priority order, and then the readers, also in priority
+   order. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func reader_thread_func;
+static thread_func writer_thread_func;
+
+void
+test_priority_rwlock (void) 
+{
+  struct rwlock rwlock;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rwlock);
+  rwlock_acquire_write (&rwlock);
+  thread_create ("writer 1", PRI_DEFAULT + 1, writer_thread_func, &rwlock);
+  thread_create ("writer 2", PRI_DEFAULT + 2, writer_thread_func, &rwlock);
+  thread_create ("reader 3", PRI_DEFAULT + 3, reader_thread_func, &rwlock);
+  thread_create ("reader 4", PRI_DEFAULT + 4, reader_thread_func, &rwlock);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 4, thread_get_priority ());
+  rwlock_release_write (&rwlock);
+  msg ("All writers and readers must already have finished.");
+}
+
+static void
+reader_thread_func (void *rwlock_) 
+{
+  struct rwlock *rwlock = rwlock_;
+
+  rwlock_acquire_read (rwlock);
+  msg ("%s: got the read lock", thread_name ());
+  rwlock_release_read (rwlock);
+}
+
+static void
+writer_thread_func (void *rwlock_) 
+{
+  struct rwlock *rwlock = rwlock_;
+
+  rwlock_acquire_write (rwlock);
+  msg ("%s: got the write lock", thread_name ());
+  rwlock_release_write (rwlock);
+}
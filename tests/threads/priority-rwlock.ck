@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(priority-rwlock) begin
+(priority-rwlock) This thread should have priority 35.  Actual priority: 35.
+(priority-rwlock) writer 2: got the write lock
+(priority-rwlock) writer 1: got the write lock
+(priority-rwlock) reader 4: got the read lock
+(priority-rwlock) reader 3: got the read lock
+(priority-rwlock) All writers and readers must already have finished.
+(priority-rwlock) end
+EOF
+pass;
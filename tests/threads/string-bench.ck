@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+@output = get_core_output ("run", @output);
+for (my $size = 8; $size <= 4096; $size *= 2) {
+    fail "missing timing for $size bytes in output"
+      unless grep (/^\(string-bench\) $size bytes: memcpy \d+, memset \d+, memcmp \d+, strlen \d+ cycles$/,
+		   @output);
+}
+fail "missing PASS in output"
+  unless grep ($_ eq '(string-bench) PASS', @output);
+
+pass;
@@ -0,0 +1,191 @@
+/* Checks the word-at-a-time memmove(), memcpy(), memset(),
+   memcmp() and strlen() against byte-by-byte reference loops.
+
+   Each function is run at every source and destination offset
+   within a word and over a range of sizes, including sizes on
+   both sides of the point where memcpy() and memset() switch to
+   the "rep" string instructions.  Guard bytes around every
+   destination must come through unchanged. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+
+/* Size at which lib/string.c starts using "rep movsq" and
+   "rep stosq". */
+#define REP_THRESHOLD 128
+
+#define BUF_SIZE 512
+#define GUARD 0xa5
+
+static unsigned char buf[BUF_SIZE], ref[BUF_SIZE], src[BUF_SIZE];
+
+/* Fills BUF_SIZE bytes at P with a pattern that depends on
+   SEED, so that no two nearby bytes are equal. */
+static void
+fill (unsigned char *p, unsigned seed)
+{
+  size_t i;
+
+  for (i = 0; i < BUF_SIZE; i++)
+    p[i] = (unsigned char) (i * 7 + seed * 13 + 1);
+}
+
+/* Fails if BUF differs from REF, naming WHAT and the
+   parameters of the failing call. */
+static void
+check (const char *what, size_t dst_ofs, size_t src_ofs, size_t size)
+{
+  size_t i;
+
+  for (i = 0; i < BUF_SIZE; i++)
+    if (buf[i] != ref[i])
+      fail ("%s(dst+%zu, src+%zu, %zu): byte %zu is %02x, expected %02x",
+            what, dst_ofs, src_ofs, size, i, buf[i], ref[i]);
+}
+
+/* Overlapping memmove() in both directions. */
+static void
+test_memmove (void)
+{
+  static const size_t sizes[] = {1, 7, 8, 9, 15, 16, 17, 63, 64, 65,
+                                 127, 128, 129, 200, 255};
+  static const size_t shifts[] = {1, 3, 7, 8, 9, 13, 64};
+  size_t i, j, ofs, k;
+
+  for (i = 0; i < sizeof sizes / sizeof *sizes; i++)
+    for (j = 0; j < sizeof shifts / sizeof *shifts; j++)
+      for (ofs = 0; ofs < 8; ofs++)
+        {
+          size_t size = sizes[i], shift = shifts[j];
+          unsigned char *lo = buf + 16 + ofs;
+
+          /* Destination above the source: must copy backward. */
+          fill (buf, size + shift);
+          fill (ref, size + shift);
+          for (k = size; k-- > 0; )
+            ref[16 + ofs + shift + k] = ref[16 + ofs + k];
+          memmove (lo + shift, lo, size);
+          check ("memmove", 16 + ofs + shift, 16 + ofs, size);
+
+          /* Destination below the source: must copy forward. */
+          fill (buf, size * shift);
+          fill (ref, size * shift);
+          for (k = 0; k < size; k++)
+            ref[16 + ofs + k] = ref[16 + ofs + shift + k];
+          memmove (lo, lo + shift, size);
+          check ("memmove", 16 + ofs, 16 + ofs + shift, size);
+        }
+  msg ("memmove: overlapping copies in both directions OK.");
+}
+
+/* memcpy() and memset() at unaligned heads and tails, around
+   REP_THRESHOLD. */
+static void
+test_memcpy_memset (void)
+{
+  size_t size, dst_ofs, src_ofs, k;
+
+  for (size = 0; size <= REP_THRESHOLD + 24; size++)
+    {
+      /* Small sizes and the sizes around the threshold. */
+      if (size > 40 && size < REP_THRESHOLD - 24)
+        continue;
+
+      for (dst_ofs = 0; dst_ofs < 8; dst_ofs++)
+        {
+          for (src_ofs = 0; src_ofs < 8; src_ofs++)
+            {
+              fill (src, size + src_ofs);
+              memset (buf, GUARD, BUF_SIZE);
+              memset (ref, GUARD, BUF_SIZE);
+              for (k = 0; k < size; k++)
+                ref[64 + dst_ofs + k] = src[src_ofs + k];
+              memcpy (buf + 64 + dst_ofs, src + src_ofs, size);
+              check ("memcpy", 64 + dst_ofs, src_ofs, size);
+            }
+
+          fill (buf, size + dst_ofs);
+          fill (ref, size + dst_ofs);
+          for (k = 0; k < size; k++)
+            ref[64 + dst_ofs + k] = 0x5c;
+          memset (buf + 64 + dst_ofs, 0x15c, size);
+          check ("memset", 64 + dst_ofs, 0, size);
+        }
+    }
+  msg ("memcpy, memset: unaligned heads and tails OK.");
+}
+
+/* The sign of memcmp() comes from the first differing byte, read
+   as unsigned, even when it is in a later word. */
+static void
+test_memcmp (void)
+{
+  size_t size, pos, ofs;
+
+  for (size = 9; size <= 72; size++)
+    for (pos = 8; pos < size; pos++)
+      for (ofs = 0; ofs < 8; ofs++)
+        {
+          unsigned char *a = buf + ofs, *b = ref + 8 - ofs;
+
+          fill (src, size);
+          memcpy (a, src, size);
+          memcpy (b, src, size);
+          if (memcmp (a, b, size) != 0)
+            fail ("memcmp of %zu equal bytes returned nonzero", size);
+
+          /* A's byte is below B's as unsigned, above as signed. */
+          a[pos] = 0x10;
+          b[pos] = 0x90;
+          /* A later difference the other way must not matter. */
+          if (pos + 1 < size)
+            {
+              a[pos + 1] = 0xff;
+              b[pos + 1] = 0x00;
+            }
+          if (memcmp (a, b, size) >= 0)
+            fail ("memcmp(a, b, %zu) with a < b at byte %zu was not "
+                  "negative", size, pos);
+          if (memcmp (b, a, size) <= 0)
+            fail ("memcmp(b, a, %zu) with b > a at byte %zu was not "
+                  "positive", size, pos);
+          if (memcmp (a, b, pos) != 0)
+            fail ("memcmp of the %zu equal bytes before the difference "
+                  "returned nonzero", pos);
+        }
+  msg ("memcmp: sign of differences in later words OK.");
+}
+
+/* strlen() starting at every offset within a word, with bytes
+   that look like zero to a careless word test before the end. */
+static void
+test_strlen (void)
+{
+  static const unsigned char fillers[] = {'x', 0x01, 0x80, 0x81, 0xff};
+  size_t f, ofs, len;
+
+  for (f = 0; f < sizeof fillers; f++)
+    for (ofs = 0; ofs < 8; ofs++)
+      for (len = 0; len <= 40; len++)
+        {
+          memset (buf, fillers[f], BUF_SIZE);
+          buf[ofs + len] = '\0';
+          if (strlen ((char *) buf + ofs) != len)
+            fail ("strlen at offset %zu of a %zu-byte string of %02x "
+                  "returned %zu", ofs, len, fillers[f],
+                  strlen ((char *) buf + ofs));
+        }
+  msg ("strlen: every starting offset OK.");
+}
+
+void
+test_string_ops (void)
+{
+  test_memmove ();
+  test_memcpy_memset ();
+  test_memcmp ();
+  test_strlen ();
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(string-ops) begin
+(string-ops) memmove: overlapping copies in both directions OK.
+(string-ops) memcpy, memset: unaligned heads and tails OK.
+(string-ops) memcmp: sign of differences in later words OK.
+(string-ops) strlen: every starting offset OK.
+(string-ops) end
+EOF
+pass;
@@ -29,6 +29,18 @@ static const struct test tests[] =
         {"priority-preempt", test_priority_preempt},
         {"priority-sema", test_priority_sema},
         {"priority-condvar", test_priority_condvar},
+        {"priority-rwlock", test_priority_rwlock},
+        {"priority-donate-rwlock", test_priority_donate_rwlock},
+        {"priority-donate-condvar", test_priority_donate_condvar},
+        {"edf-admit", test_edf_admit},
+        {"edf-throttle", test_edf_throttle},
+        {"edf-order", test_edf_order},
+        {"ctxsw-bench", test_ctxsw_bench},
+        {"malloc-bench", test_malloc_bench},
+        {"string-bench", test_string_bench},
+        {"string-ops", test_string_ops},
+        {"bitmap-scan", test_bitmap_scan},
+        {"workqueue", test_workqueue},
         {"mlfqs-load-1", test_mlfqs_load_1},
         {"mlfqs-load-60", test_mlfqs_load_60},
         {"mlfqs-load-avg", test_mlfqs_load_avg},
@@ -38,6 +50,9 @@ static const struct test tests[] =
         {"mlfqs-nice-2", test_mlfqs_nice_2},
         {"mlfqs-nice-10", test_mlfqs_nice_10},
         {"mlfqs-block", test_mlfqs_block},
+        {"cfs-fair-2", test_cfs_fair_2},
+        {"cfs-nice-2", test_cfs_nice_2},
+        {"cfs-nice-10", test_cfs_nice_10},
 };
 
 static const char *test_name;
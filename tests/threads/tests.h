@@ -19,10 +19,22 @@ extern test_func test_priority_donate_sema;
 extern test_func test_priority_donate_nest;
 extern test_func test_priority_donate_lower;
 extern test_func test_priority_donate_chain;
+extern test_func test_priority_donate_rwlock;
+extern test_func test_priority_donate_condvar;
+extern test_func test_edf_admit;
+extern test_func test_edf_throttle;
+extern test_func test_edf_order;
 extern test_func test_priority_fifo;
 extern test_func test_priority_preempt;
 extern test_func test_priority_sema;
 extern test_func test_priority_condvar;
+extern test_func test_priority_rwlock;
+extern test_func test_ctxsw_bench;
+extern test_func test_malloc_bench;
+extern test_func test_string_bench;
+extern test_func test_string_ops;
+extern test_func test_bitmap_scan;
+extern test_func test_workqueue;
 extern test_func test_mlfqs_load_1;
 extern test_func test_mlfqs_load_60;
 extern test_func test_mlfqs_load_avg;
@@ -32,6 +44,9 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_cfs_fair_2;
+extern test_func test_cfs_nice_2;
+extern test_func test_cfs_nice_10;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
@@ -0,0 +1,131 @@
+/* Checks the kernel work queues in threads/workqueue.c.
+
+   Work queued on WQ_NORMAL while its worker cannot run must run
+   in the order it was queued, and queueing a work that is still
+   pending must not run it twice.  Work queued on WQ_HIGH must
+   preempt the PRI_DEFAULT thread that queued it.  Finally, work
+   is queued from an external interrupt handler, which we raise
+   with "int" on the otherwise unused IRQ 7 vector. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+
+#define WORK_CNT 8
+
+/* Interrupt vector for IRQ 7, which nothing else uses. */
+#define TEST_IRQ 0x27
+
+static struct work works[WORK_CNT];
+static struct work high_work, irq_high_work, irq_normal_work;
+static struct semaphore done;
+static int remaining;
+static bool handler_in_intr_context;
+
+static work_func numbered_work, high_func, irq_high_func, irq_normal_func;
+static intr_handler_func test_irq;
+
+void
+test_workqueue (void)
+{
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  sema_init (&done, 0);
+
+  /* Queue everything above the WQ_NORMAL worker's priority, so
+     that it finds the whole batch when it runs. */
+  remaining = WORK_CNT;
+  thread_set_priority (PRI_DEFAULT + 1);
+  for (i = 0; i < WORK_CNT; i++)
+    {
+      work_init (&works[i], numbered_work, (void *) (intptr_t) i);
+      if (!work_queue (WQ_NORMAL, &works[i]))
+        fail ("work_queue of new work %d returned false", i);
+    }
+  if (work_queue (WQ_NORMAL, &works[0]))
+    fail ("work_queue of pending work 0 returned true");
+  msg ("Queued %d works and work 0 again.", WORK_CNT);
+  thread_set_priority (PRI_DEFAULT);
+  sema_down (&done);
+
+  /* Work 0 has run, so it can be queued again. */
+  remaining = 1;
+  if (!work_queue (WQ_NORMAL, &works[0]))
+    fail ("work_queue of finished work 0 returned false");
+  sema_down (&done);
+
+  /* WQ_HIGH runs at PRI_MAX and preempts us right away. */
+  work_init (&high_work, high_func, NULL);
+  msg ("Queueing work on WQ_HIGH.");
+  work_queue (WQ_HIGH, &high_work);
+  msg ("work_queue on WQ_HIGH returned.");
+
+  /* From an interrupt, WQ_HIGH runs as the handler returns, but
+     WQ_NORMAL waits until we drop below its worker. */
+  work_init (&irq_high_work, irq_high_func, NULL);
+  work_init (&irq_normal_work, irq_normal_func, NULL);
+  intr_register_ext (TEST_IRQ, test_irq, "workqueue test");
+  thread_set_priority (PRI_DEFAULT + 1);
+  msg ("Raising interrupt.");
+  asm volatile ("int %0" : : "i" (TEST_IRQ));
+  msg ("Interrupt returned.");
+  if (!handler_in_intr_context)
+    fail ("handler did not run in external interrupt context");
+  thread_set_priority (PRI_DEFAULT);
+  sema_down (&done);
+}
+
+/* Work number AUX.  Wakes up the main thread once REMAINING
+   works have run. */
+static void
+numbered_work (void *aux)
+{
+  int i = (intptr_t) aux;
+
+  msg ("Work %d running.", i);
+  if (thread_get_priority () != PRI_DEFAULT)
+    fail ("work %d ran at priority %d", i, thread_get_priority ());
+  if (--remaining == 0)
+    sema_up (&done);
+}
+
+static void
+high_func (void *aux UNUSED)
+{
+  msg ("WQ_HIGH work running at priority %d.", thread_get_priority ());
+}
+
+/* Runs on IRQ 7 in external interrupt context. */
+static void
+test_irq (struct intr_frame *f UNUSED)
+{
+  handler_in_intr_context = intr_context ();
+  work_queue (WQ_HIGH, &irq_high_work);
+  work_queue (WQ_NORMAL, &irq_normal_work);
+}
+
+static void
+irq_high_func (void *aux UNUSED)
+{
+  if (intr_context () || intr_get_level () != INTR_ON)
+    fail ("work queued from an interrupt ran with interrupts off");
+  msg ("WQ_HIGH work queued from interrupt running.");
+}
+
+static void
+irq_normal_func (void *aux UNUSED)
+{
+  msg ("WQ_NORMAL work queued from interrupt running.");
+  sema_up (&done);
+}
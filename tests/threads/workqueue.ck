@@ -0,0 +1,26 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workqueue) begin
+(workqueue) Queued 8 works and work 0 again.
+(workqueue) Work 0 running.
+(workqueue) Work 1 running.
+(workqueue) Work 2 running.
+(workqueue) Work 3 running.
+(workqueue) Work 4 running.
+(workqueue) Work 5 running.
+(workqueue) Work 6 running.
+(workqueue) Work 7 running.
+(workqueue) Work 0 running.
+(workqueue) Queueing work on WQ_HIGH.
+(workqueue) WQ_HIGH work running at priority 63.
+(workqueue) work_queue on WQ_HIGH returned.
+(workqueue) Raising interrupt.
+(workqueue) WQ_HIGH work queued from interrupt running.
+(workqueue) Interrupt returned.
+(workqueue) WQ_NORMAL work queued from interrupt running.
+(workqueue) end
+EOF
+pass;
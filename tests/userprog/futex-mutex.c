@@ -0,0 +1,76 @@
+/* Has several threads increment a shared counter under a umutex
+   and hand values over through a ucond, checking that futex-based
+   user synchronization loses no updates or wakeups. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include <usynch.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 4
+#define ITER_CNT 500
+
+static struct umutex mutex = UMUTEX_INITIALIZER;
+static struct ucond cond = UCOND_INITIALIZER;
+static int counter;
+static int handed;
+
+static void
+incrementer (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < ITER_CNT; i++)
+    {
+      int value;
+      volatile int spin;
+
+      umutex_acquire (&mutex);
+      value = counter;
+      for (spin = 0; spin < 100; spin++)
+        continue;
+      counter = value + 1;
+      umutex_release (&mutex);
+    }
+}
+
+static void
+consumer (void *aux UNUSED) 
+{
+  umutex_acquire (&mutex);
+  while (handed == 0)
+    ucond_wait (&cond, &mutex);
+  handed--;
+  umutex_release (&mutex);
+}
+
+void
+test_main (void) 
+{
+  uthread_t tids[THREAD_CNT];
+  int word = 5;
+  int i;
+
+  CHECK (futex (&word, FUTEX_WAIT, 6) == -1, "wait on changed value returns");
+  CHECK (futex (&word, FUTEX_WAKE, 1) == 0, "wake with no waiters");
+
+  for (i = 0; i < THREAD_CNT; i++)
+    tids[i] = uthread_create (incrementer, NULL);
+  for (i = 0; i < THREAD_CNT; i++)
+    uthread_join (tids[i]);
+  CHECK (counter == THREAD_CNT * ITER_CNT, "counter = %d", counter);
+
+  for (i = 0; i < THREAD_CNT; i++)
+    tids[i] = uthread_create (consumer, NULL);
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      umutex_acquire (&mutex);
+      handed++;
+      ucond_signal (&cond);
+      umutex_release (&mutex);
+    }
+  for (i = 0; i < THREAD_CNT; i++)
+    uthread_join (tids[i]);
+  CHECK (handed == 0, "every consumer was woken");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex-mutex) begin
+(futex-mutex) wait on changed value returns
+(futex-mutex) wake with no waiters
+(futex-mutex) counter = 2000
+(futex-mutex) every consumer was woken
+(futex-mutex) end
+futex-mutex: exit(0)
+EOF
+pass;
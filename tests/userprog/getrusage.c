@@ -0,0 +1,33 @@
+/* Checks that getrusage() reports the caller's own usage and
+   folds the usage of a waited-for child into RUSAGE_CHILDREN. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct rusage self, children;
+  int pid;
+
+  CHECK (getrusage (RUSAGE_SELF, &self) == 0, "getrusage(RUSAGE_SELF)");
+  CHECK (self.ru_nsyscalls > 0, "self has made system calls");
+  CHECK (getrusage (RUSAGE_CHILDREN, &children) == 0,
+         "getrusage(RUSAGE_CHILDREN)");
+  CHECK (children.ru_nsyscalls == 0, "no children waited for yet");
+
+  if ((pid = fork ("child")) == 0)
+    {
+      int i;
+
+      for (i = 0; i < 10; i++)
+        getrusage (RUSAGE_SELF, &self);
+      exit (7);
+    }
+
+  msg ("wait(child) = %d", wait (pid));
+  getrusage (RUSAGE_CHILDREN, &children);
+  CHECK (children.ru_nsyscalls >= 11, "child's system calls were collected");
+  CHECK (getrusage (1, &self) == -1, "invalid who is rejected");
+}
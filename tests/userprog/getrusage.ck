@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(getrusage) begin
+(getrusage) getrusage(RUSAGE_SELF)
+(getrusage) self has made system calls
+(getrusage) getrusage(RUSAGE_CHILDREN)
+(getrusage) no children waited for yet
+child: exit(7)
+(getrusage) wait(child) = 7
+(getrusage) child's system calls were collected
+(getrusage) invalid who is rejected
+(getrusage) end
+getrusage: exit(0)
+EOF
+pass;
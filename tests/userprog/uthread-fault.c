@@ -0,0 +1,24 @@
+/* A thread made by uthread_create() dereferences NULL while the
+   main thread spins without making system calls.  The fault must
+   take down the whole process, including the spinning thread,
+   with exit code -1. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static void
+bad_thread (void *aux UNUSED) 
+{
+  msg ("Congratulations - you have successfully dereferenced NULL: %d",
+       *(volatile int *) NULL);
+}
+
+void
+test_main (void) 
+{
+  CHECK (uthread_create (bad_thread, NULL) != UTHREAD_ERROR,
+         "create thread");
+  for (;;)
+    continue;
+}
@@ -0,0 +1,49 @@
+/* Starts several threads that share the process's memory, each
+   summing one slice of a global array, and joins them. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 4
+#define SLICE 1000
+
+static int values[THREAD_CNT * SLICE];
+static long long sums[THREAD_CNT];
+
+static void
+sum_slice (void *aux) 
+{
+  int idx = (intptr_t) aux;
+  long long sum = 0;
+  int i;
+
+  for (i = idx * SLICE; i < (idx + 1) * SLICE; i++)
+    sum += values[i];
+  sums[idx] = sum;
+  uthread_exit (idx + 10);
+}
+
+void
+test_main (void) 
+{
+  uthread_t tids[THREAD_CNT];
+  long long total = 0;
+  int i;
+
+  for (i = 0; i < THREAD_CNT * SLICE; i++)
+    values[i] = i;
+
+  for (i = 0; i < THREAD_CNT; i++)
+    CHECK ((tids[i] = uthread_create (sum_slice, (void *) (intptr_t) i))
+           != UTHREAD_ERROR, "create thread %d", i);
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      msg ("join thread %d = %d", i, uthread_join (tids[i]));
+      total += sums[i];
+    }
+  CHECK (total == (long long) THREAD_CNT * SLICE * (THREAD_CNT * SLICE - 1) / 2,
+         "sum is correct");
+  CHECK (uthread_join (tids[0]) == -1, "second join fails");
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(uthread-simple) begin
+(uthread-simple) create thread 0
+(uthread-simple) create thread 1
+(uthread-simple) create thread 2
+(uthread-simple) create thread 3
+(uthread-simple) join thread 0 = 10
+(uthread-simple) join thread 1 = 11
+(uthread-simple) join thread 2 = 12
+(uthread-simple) join thread 3 = 13
+(uthread-simple) sum is correct
+(uthread-simple) second join fails
+(uthread-simple) end
+uthread-simple: exit(0)
+EOF
+pass;
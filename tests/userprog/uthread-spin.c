@@ -0,0 +1,27 @@
+/* The main thread exits while a thread made by uthread_create()
+   spins without making system calls.  The spinning thread must be
+   stopped so that the process can exit. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static volatile int started;
+
+static void
+spin_thread (void *aux UNUSED) 
+{
+  started = 1;
+  for (;;)
+    continue;
+}
+
+void
+test_main (void) 
+{
+  CHECK (uthread_create (spin_thread, NULL) != UTHREAD_ERROR,
+         "create thread");
+  while (!started)
+    continue;
+  msg ("thread is spinning");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(uthread-spin) begin
+(uthread-spin) create thread
+(uthread-spin) thread is spinning
+(uthread-spin) end
+uthread-spin: exit(0)
+EOF
+pass;
@@ -0,0 +1,25 @@
+/* Verifies that a thread made by uthread_create() is not a child
+   process: wait() on its tid fails both while it runs and after
+   it has been joined. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static void
+child_thread (void *aux UNUSED) 
+{
+  uthread_exit (42);
+}
+
+void
+test_main (void) 
+{
+  uthread_t tid;
+
+  CHECK ((tid = uthread_create (child_thread, NULL)) != UTHREAD_ERROR,
+         "create thread");
+  CHECK (wait (tid) == -1, "wait before join fails");
+  msg ("join thread = %d", uthread_join (tid));
+  CHECK (wait (tid) == -1, "wait after join fails");
+}
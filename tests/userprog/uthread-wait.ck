@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(uthread-wait) begin
+(uthread-wait) create thread
+(uthread-wait) wait before join fails
+(uthread-wait) join thread = 42
+(uthread-wait) wait after join fails
+(uthread-wait) end
+uthread-wait: exit(0)
+EOF
+pass;
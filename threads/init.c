@@ -19,8 +19,11 @@
 #include "threads/malloc.h"
 #include "threads/mmu.h"
 #include "threads/palloc.h"
+#include "threads/slab.h"
 #include "threads/pte.h"
 #include "threads/thread.h"
+#include "threads/schedtrace.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
@@ -85,6 +88,7 @@ main (void) {
 	/* Initialize memory system. */
 	mem_end = palloc_init ();
 	malloc_init ();
+	slab_init ();
 	paging_init (mem_end);
 
 #ifdef USERPROG
@@ -103,6 +107,7 @@ main (void) {
 #endif
 	/* Start thread scheduler and enable interrupts. */
 	thread_start ();
+	workqueue_init ();
 	serial_init_queue ();
 	timer_calibrate ();
 
@@ -221,6 +226,14 @@ parse_options (char **argv) {
 			random_init (atoi (value));
 		else if (!strcmp (name, "-mlfqs"))
 			thread_mlfqs = true;
+		else if (!strcmp (name, "-cfs"))
+			thread_cfs = true;
+		else if (!strcmp (name, "-tickless"))
+			timer_tickless = true;
+		else if (!strcmp (name, "-sched-trace"))
+			sched_trace_enabled = true;
+		else if (!strcmp (name, "-lockstat"))
+			lockstat_enabled = true;
 #ifdef USERPROG
 		else if (!strcmp (name, "-ul"))
 			user_page_limit = atoi (value);
@@ -231,6 +244,9 @@ parse_options (char **argv) {
 			PANIC ("unknown option `%s' (use -h for help)", name);
 	}
 
+	if (thread_mlfqs && thread_cfs)
+		PANIC ("-mlfqs and -cfs cannot be used together");
+
 	return argv;
 }
 
@@ -266,6 +282,7 @@ run_actions (char **argv) {
 	/* Table of supported actions. */
 	static const struct action actions[] = {
 		{"run", 2, run_task},
+		{"sched-trace", 1, sched_trace_dump},
 #ifdef FILESYS
 		{"ls", 1, fsutil_ls},
 		{"cat", 2, fsutil_cat},
@@ -312,6 +329,7 @@ usage (void) {
 #else
 			"  run TEST           Run TEST.\n"
 #endif
+			"  sched-trace        Dump the scheduler event trace buffer.\n"
 #ifdef FILESYS
 			"  ls                 List files in the root directory.\n"
 			"  cat FILE           Print FILE to the console.\n"
@@ -326,6 +344,10 @@ usage (void) {
 			"  -f                 Format file system disk during startup.\n"
 			"  -rs=SEED           Set random number seed to SEED.\n"
 			"  -mlfqs             Use multi-level feedback queue scheduler.\n"
+			"  -cfs               Use weighted fair-share (vruntime) scheduler.\n"
+			"  -tickless          Stop the periodic timer tick while idle.\n"
+			"  -sched-trace       Record scheduler events and latencies.\n"
+			"  -lockstat          Record lock contention statistics.\n"
 #ifdef USERPROG
 			"  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -354,6 +376,13 @@ static void
 print_stats (void) {
 	timer_print_stats ();
 	thread_print_stats ();
+	pml4_print_stats ();
+	palloc_print_stats ();
+	malloc_print_stats ();
+	slab_print_stats ();
+	sched_trace_print_stats ();
+	lockstat_print_stats ();
+	workqueue_print_stats ();
 #ifdef FILESYS
 	disk_print_stats ();
 #endif
@@ -361,5 +390,6 @@ print_stats (void) {
 	kbd_print_stats ();
 #ifdef USERPROG
 	exception_print_stats ();
+	process_print_stats ();
 #endif
 }
@@ -13,6 +13,7 @@
 #include "intrinsic.h"
 #ifdef USERPROG
 #include "userprog/gdt.h"
+#include "userprog/syscall.h"
 #endif
 
 /* Number of x86_64 interrupts. */
@@ -372,6 +373,14 @@ intr_handler (struct intr_frame *frame) {
 		if (yield_on_return)
 			thread_yield ();
 	}
+
+#ifdef USERPROG
+	/* Returning to user mode: if another thread of this process
+	   started tearing it down, die here instead.  This catches
+	   threads that never make a system call. */
+	if (frame->cs == SEL_UCSEG)
+		exit_group_check ();
+#endif
 }
 
 /* Dumps interrupt frame F to the console, for debugging. */
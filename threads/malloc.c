@@ -6,7 +6,9 @@
 #include <stdio.h>
 #include <string.h>
 #include "threads/palloc.h"
+#include "threads/interrupt.h"
 #include "threads/synch.h"
+#include "threads/thread.h"
 #include "threads/vaddr.h"
 
 /* A simple implementation of malloc().
@@ -32,7 +34,21 @@
    because they're too big to fit in a single page with a
    descriptor.  We handle those by allocating contiguous pages
    with the page allocator and sticking the allocation size at
-   the beginning of the allocated block's arena header. */
+   the beginning of the allocated block's arena header.
+
+   Every descriptor has a single lock, so to keep threads from
+   serializing on it, each thread also owns a "magazine" of free
+   blocks per descriptor.  malloc() and free() normally just pop
+   and push the calling thread's magazine without any locking.
+   Only when the magazine runs empty (or full) is the descriptor
+   locked, and then MAG_BATCH blocks move from (or to) the shared
+   free list at once.  From the arena's point of view, blocks in a
+   magazine are still in use; a thread's magazines are drained
+   back into the free lists when it exits. */
+
+/* Blocks per magazine, and blocks moved per refill or drain. */
+#define MAG_SIZE 16
+#define MAG_BATCH (MAG_SIZE / 2)
 
 /* Descriptor. */
 struct desc {
@@ -40,6 +56,8 @@ struct desc {
 	size_t blocks_per_arena;    /* Number of blocks in an arena. */
 	struct list free_list;      /* List of free blocks. */
 	struct lock lock;           /* Lock. */
+	long long refill_cnt;       /* Magazine refills from FREE_LIST. */
+	long long drain_cnt;        /* Magazine drains into FREE_LIST. */
 };
 
 /* Magic number for detecting arena corruption. */
@@ -54,7 +72,10 @@ struct arena {
 
 /* Free block. */
 struct block {
-	struct list_elem free_elem; /* Free list element. */
+	union {
+		struct list_elem free_elem; /* Free list element. */
+		struct block *mag_next;     /* Next block in a magazine. */
+	};
 };
 
 /* Our set of descriptors. */
@@ -63,6 +84,9 @@ static size_t desc_cnt;         /* Number of descriptors. */
 
 static struct arena *block_to_arena (struct block *);
 static struct block *arena_to_block (struct arena *, size_t idx);
+static bool desc_get_blocks (struct desc *, struct malloc_magazine *);
+static void desc_put_blocks (struct desc *, struct malloc_magazine *,
+		unsigned cnt);
 
 /* Initializes the malloc() descriptors. */
 void
@@ -76,7 +100,42 @@ malloc_init (void) {
 		d->blocks_per_arena = (PGSIZE - sizeof (struct arena)) / block_size;
 		list_init (&d->free_list);
 		lock_init (&d->lock);
+		d->refill_cnt = d->drain_cnt = 0;
 	}
+	ASSERT (desc_cnt == MALLOC_MAG_CLASSES);
+}
+
+/* Returns the calling thread's magazine for descriptor D. */
+static struct malloc_magazine *
+desc_magazine (struct desc *d) {
+	ASSERT (!intr_context ());
+	return &thread_current ()->ext->malloc_mag[d - descs];
+}
+
+/* Gives every block in the calling thread's magazines back to
+   the descriptors' free lists.  Called when a thread exits. */
+void
+malloc_drain (void) {
+	struct desc *d;
+
+	for (d = descs; d < descs + desc_cnt; d++) {
+		struct malloc_magazine *m = desc_magazine (d);
+		if (m->cnt > 0)
+			desc_put_blocks (d, m, m->cnt);
+	}
+}
+
+/* Prints malloc statistics. */
+void
+malloc_print_stats (void) {
+	long long refills = 0, drains = 0;
+	struct desc *d;
+
+	for (d = descs; d < descs + desc_cnt; d++) {
+		refills += d->refill_cnt;
+		drains += d->drain_cnt;
+	}
+	printf ("Malloc: %lld magazine refills, %lld drains\n", refills, drains);
 }
 
 /* Obtains and returns a new block of at least SIZE bytes.
@@ -86,6 +145,7 @@ malloc (size_t size) {
 	struct desc *d;
 	struct block *b;
 	struct arena *a;
+	struct malloc_magazine *m;
 
 	/* A null pointer satisfies a request for 0 bytes. */
 	if (size == 0)
@@ -112,6 +172,25 @@ malloc (size_t size) {
 		return a + 1;
 	}
 
+	/* Get a block from this thread's magazine, refilling it from
+	   the free list if it is empty. */
+	m = desc_magazine (d);
+	if (m->cnt == 0 && !desc_get_blocks (d, m))
+		return NULL;
+	b = m->head;
+	m->head = b->mag_next;
+	m->cnt--;
+	return b;
+}
+
+/* Moves up to MAG_BATCH blocks from D's free list into magazine
+   M, creating a new arena if the free list is empty.  Returns
+   false if no memory is available. */
+static bool
+desc_get_blocks (struct desc *d, struct malloc_magazine *m) {
+	struct arena *a;
+	unsigned i;
+
 	lock_acquire (&d->lock);
 
 	/* If the free list is empty, create a new arena. */
@@ -122,7 +201,7 @@ malloc (size_t size) {
 		a = palloc_get_page (0);
 		if (a == NULL) {
 			lock_release (&d->lock);
-			return NULL;
+			return false;
 		}
 
 		/* Initialize arena and add its blocks to the free list. */
@@ -135,12 +214,52 @@ malloc (size_t size) {
 		}
 	}
 
-	/* Get a block from free list and return it. */
-	b = list_entry (list_pop_front (&d->free_list), struct block, free_elem);
-	a = block_to_arena (b);
-	a->free_cnt--;
+	/* Move blocks from the free list to the magazine. */
+	for (i = 0; i < MAG_BATCH && !list_empty (&d->free_list); i++) {
+		struct block *b = list_entry (list_pop_front (&d->free_list),
+				struct block, free_elem);
+		a = block_to_arena (b);
+		a->free_cnt--;
+		b->mag_next = m->head;
+		m->head = b;
+		m->cnt++;
+	}
+	d->refill_cnt++;
+	lock_release (&d->lock);
+	return true;
+}
+
+/* Moves CNT blocks from magazine M back to D's free list,
+   freeing any arena that becomes entirely unused. */
+static void
+desc_put_blocks (struct desc *d, struct malloc_magazine *m, unsigned cnt) {
+	ASSERT (cnt <= m->cnt);
+
+	lock_acquire (&d->lock);
+	while (cnt-- > 0) {
+		struct block *b = m->head;
+		struct arena *a = block_to_arena (b);
+
+		m->head = b->mag_next;
+		m->cnt--;
+
+		/* Add block to free list. */
+		list_push_front (&d->free_list, &b->free_elem);
+
+		/* If the arena is now entirely unused, free it. */
+		if (++a->free_cnt >= d->blocks_per_arena) {
+			size_t i;
+
+			ASSERT (a->free_cnt == d->blocks_per_arena);
+			for (i = 0; i < d->blocks_per_arena; i++) {
+				struct block *b = arena_to_block (a, i);
+				list_remove (&b->free_elem);
+			}
+			palloc_free_page (a);
+		}
+	}
+	d->drain_cnt++;
 	lock_release (&d->lock);
-	return b;
 }
 
 /* Allocates and return A times B bytes initialized to zeroes.
@@ -213,24 +332,14 @@ free (void *p) {
 			memset (b, 0xcc, d->block_size);
 #endif
 
-			lock_acquire (&d->lock);
-
-			/* Add block to free list. */
-			list_push_front (&d->free_list, &b->free_elem);
-
-			/* If the arena is now entirely unused, free it. */
-			if (++a->free_cnt >= d->blocks_per_arena) {
-				size_t i;
-
-				ASSERT (a->free_cnt == d->blocks_per_arena);
-				for (i = 0; i < d->blocks_per_arena; i++) {
-					struct block *b = arena_to_block (a, i);
-					list_remove (&b->free_elem);
-				}
-				palloc_free_page (a);
-			}
-
-			lock_release (&d->lock);
+			/* Put the block in this thread's magazine, first
+			   draining half of it if it is full. */
+			struct malloc_magazine *m = desc_magazine (d);
+			if (m->cnt >= MAG_SIZE)
+				desc_put_blocks (d, m, MAG_BATCH);
+			b->mag_next = m->head;
+			m->head = b;
+			m->cnt++;
 		} else {
 			/* It's a big block.  Free its pages. */
 			palloc_free_multiple (a, a->free_cnt);
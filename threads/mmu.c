@@ -6,7 +6,18 @@
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
+#include "threads/interrupt.h"
 #include "intrinsic.h"
+#include <stdio.h>
+
+/* Cache of destroyed page-map-level-4 pages.  Each cached page
+   already holds the kernel mappings copied from base_pml4, so
+   pml4_create() can hand it out without copying a whole page. */
+#define PML4_CACHE_MAX 32
+static uint64_t *pml4_cache[PML4_CACHE_MAX];
+static size_t pml4_cache_cnt;
+static long long pml4_cache_hits;
+static long long pml4_cache_misses;
 
 static uint64_t *
 pgdir_walk (uint64_t *pdp, const uint64_t va, int create) {
@@ -94,7 +105,18 @@ pml4e_walk (uint64_t *pml4e, const uint64_t va, int create) {
  * allocation fails. */
 uint64_t *
 pml4_create (void) {
-	uint64_t *pml4 = palloc_get_page (0);
+	uint64_t *pml4 = NULL;
+	enum intr_level old_level = intr_disable ();
+	if (pml4_cache_cnt > 0) {
+		pml4 = pml4_cache[--pml4_cache_cnt];
+		pml4_cache_hits++;
+	} else
+		pml4_cache_misses++;
+	intr_set_level (old_level);
+	if (pml4 != NULL)
+		return pml4;
+
+	pml4 = palloc_get_page (0);
 	if (pml4)
 		memcpy (pml4, base_pml4, PGSIZE);
 	return pml4;
@@ -196,7 +218,25 @@ pml4_destroy (uint64_t *pml4) {
 	uint64_t *pdpe = ptov ((uint64_t *) pml4[0]);
 	if (((uint64_t) pdpe) & PTE_P)
 		pdpe_destroy ((void *) PTE_ADDR (pdpe));
-	palloc_free_page ((void *) pml4);
+
+	/* Only the user half was torn down, so the kernel mappings are
+	   still intact.  Restore the user entry and keep the page. */
+	pml4[0] = base_pml4[0];
+	enum intr_level old_level = intr_disable ();
+	if (pml4_cache_cnt < PML4_CACHE_MAX) {
+		pml4_cache[pml4_cache_cnt++] = pml4;
+		pml4 = NULL;
+	}
+	intr_set_level (old_level);
+	if (pml4 != NULL)
+		palloc_free_page ((void *) pml4);
+}
+
+/* Prints pml4 cache statistics. */
+void
+pml4_print_stats (void) {
+	printf ("Page map cache: %lld hits, %lld misses\n",
+			pml4_cache_hits, pml4_cache_misses);
 }
 
 /* Loads page directory PD into the CPU's page directory base
@@ -2,12 +2,14 @@
 #include <bitmap.h>
 #include <debug.h>
 #include <inttypes.h>
+#include <list.h>
 #include <round.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -24,13 +26,32 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   Within a pool, free pages are managed by a binary buddy
+   allocator.  A free block of order K is 2**K contiguous pages
+   whose first page index is a multiple of 2**K; free blocks are
+   kept on one list per order, linked through their first page.
+   A request for N pages takes the smallest free block of order
+   ceil(log2(N)), splitting larger blocks as needed, and gives the
+   unused tail back.  Freeing a run of pages breaks it into
+   aligned blocks and merges each with its buddy while the buddy
+   is free too, so both operations take O(log n) steps.  That is
+   short enough to hold the pool's spinlock with interrupts off,
+   which also lets pages be freed from inside the scheduler. */
+
+/* Largest buddy block: 2**PALLOC_MAX_ORDER pages (1 GB). */
+#define PALLOC_MAX_ORDER 18
 
 /* A memory pool. */
 struct pool {
-	struct lock lock;               /* Mutual exclusion. */
+	struct spinlock lock;           /* Mutual exclusion. */
 	struct bitmap *used_map;        /* Bitmap of free pages. */
 	uint8_t *base;                  /* Base of pool. */
+	uint8_t *order_map;             /* Per page: order + 1 if it heads
+	                                   a free block, otherwise 0. */
+	struct list free_list[PALLOC_MAX_ORDER + 1]; /* Free blocks by order. */
+	size_t free_cnt[PALLOC_MAX_ORDER + 1];       /* Length of each list. */
 };
 
 /* Two pools: one for kernel data, one for user pages. */
@@ -42,6 +63,8 @@ static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end);
 
 static bool page_from_pool (const struct pool *, void *page);
+static size_t pool_alloc (struct pool *, size_t page_cnt);
+static void pool_free (struct pool *, size_t page_idx, size_t page_cnt);
 
 /* multiboot info */
 struct multiboot_info {
@@ -223,12 +246,12 @@ split:
 			page_idx = pg_no (start) - pg_no (pool->base);
 			if ((uint64_t) pool_end < end) {
 				page_cnt = ((uint64_t) pool_end - start) / PGSIZE;
-				bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+				pool_free (pool, page_idx, page_cnt);
 				start = (uint64_t) pool_end;
 				goto split;
 			} else {
 				page_cnt = ((uint64_t) end - start) / PGSIZE;
-				bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+				pool_free (pool, page_idx, page_cnt);
 			}
 		}
 	}
@@ -263,9 +286,14 @@ void *
 palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
 
-	lock_acquire (&pool->lock);
-	size_t page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
-	lock_release (&pool->lock);
+	if (page_cnt == 0)
+		return NULL;
+
+	enum intr_level old_level = intr_disable ();
+	spinlock_acquire (&pool->lock);
+	size_t page_idx = pool_alloc (pool, page_cnt);
+	spinlock_release (&pool->lock);
+	intr_set_level (old_level);
 	void *pages;
 
 	if (page_idx != BITMAP_ERROR)
@@ -318,8 +346,12 @@ palloc_free_multiple (void *pages, size_t page_cnt) {
 #ifndef NDEBUG
 	memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
+	enum intr_level old_level = intr_disable ();
+	spinlock_acquire (&pool->lock);
 	ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
-	bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+	pool_free (pool, page_idx, page_cnt);
+	spinlock_release (&pool->lock);
+	intr_set_level (old_level);
 }
 
 /* Frees the page at PAGE. */
@@ -335,18 +367,152 @@ init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
      Calculate the space needed for the bitmap
      and subtract it from the pool's size. */
 	uint64_t pgcnt = (end - start) / PGSIZE;
-	size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (pgcnt), PGSIZE) * PGSIZE;
+	size_t bm_size = ROUND_UP (bitmap_buf_size (pgcnt), sizeof (uint64_t));
+	size_t bm_pages = DIV_ROUND_UP (bm_size + pgcnt, PGSIZE) * PGSIZE;
+	int order;
 
-	lock_init(&p->lock);
-	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_pages);
+	spinlock_init_named (&p->lock, p == &kernel_pool ? "kernel_pool" : "user_pool");
+	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_size);
 	p->base = (void *) start;
 
+	/* The order map lives right after the bitmap.  No page heads
+	   a free block until populate_pools() frees the usable ones. */
+	p->order_map = (uint8_t *) *bm_base + bm_size;
+	memset (p->order_map, 0, pgcnt);
+	for (order = 0; order <= PALLOC_MAX_ORDER; order++) {
+		list_init (&p->free_list[order]);
+		p->free_cnt[order] = 0;
+	}
+
 	// Mark all to unusable.
 	bitmap_set_all(p->used_map, true);
 
 	*bm_base += bm_pages;
 }
 
+/* Returns the free-list element stored in the first page of the
+   block at PAGE_IDX in POOL. */
+static struct list_elem *
+block_elem (const struct pool *pool, size_t page_idx) {
+	return (struct list_elem *) (pool->base + PGSIZE * page_idx);
+}
+
+/* Returns the index of the block whose free-list element is E. */
+static size_t
+block_idx (const struct pool *pool, struct list_elem *e) {
+	return ((uint8_t *) e - pool->base) / PGSIZE;
+}
+
+/* Puts the free block of ORDER at PAGE_IDX on POOL's free list. */
+static void
+block_insert (struct pool *pool, size_t page_idx, int order) {
+	pool->order_map[page_idx] = order + 1;
+	list_push_front (&pool->free_list[order], block_elem (pool, page_idx));
+	pool->free_cnt[order]++;
+}
+
+/* Takes the free block of ORDER at PAGE_IDX off POOL's free list. */
+static void
+block_remove (struct pool *pool, size_t page_idx, int order) {
+	ASSERT (pool->order_map[page_idx] == order + 1);
+	pool->order_map[page_idx] = 0;
+	list_remove (block_elem (pool, page_idx));
+	pool->free_cnt[order]--;
+}
+
+/* Frees the block of ORDER at PAGE_IDX, merging it with its buddy
+   for as long as the buddy is a free block of the same order. */
+static void
+block_free (struct pool *pool, size_t page_idx, int order) {
+	size_t pgcnt = bitmap_size (pool->used_map);
+
+	while (order < PALLOC_MAX_ORDER) {
+		size_t buddy = page_idx ^ ((size_t) 1 << order);
+		if (buddy + ((size_t) 1 << order) > pgcnt
+				|| pool->order_map[buddy] != order + 1)
+			break;
+		block_remove (pool, buddy, order);
+		if (buddy < page_idx)
+			page_idx = buddy;
+		order++;
+	}
+	block_insert (pool, page_idx, order);
+}
+
+/* Marks the PAGE_CNT pages starting at PAGE_IDX in POOL free,
+   breaking the run into the largest aligned buddy blocks. */
+static void
+pool_free (struct pool *pool, size_t page_idx, size_t page_cnt) {
+	bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+	while (page_cnt > 0) {
+		int order = 0;
+		while (order < PALLOC_MAX_ORDER
+				&& (page_idx & ((size_t) 1 << order)) == 0
+				&& ((size_t) 2 << order) <= page_cnt)
+			order++;
+		block_free (pool, page_idx, order);
+		page_idx += (size_t) 1 << order;
+		page_cnt -= (size_t) 1 << order;
+	}
+}
+
+/* Allocates PAGE_CNT contiguous pages from POOL and returns the
+   index of the first one, or BITMAP_ERROR if no free block is
+   large enough. */
+static size_t
+pool_alloc (struct pool *pool, size_t page_cnt) {
+	size_t page_idx, block_cnt;
+	int order = 0, found;
+
+	while (((size_t) 1 << order) < page_cnt)
+		if (++order > PALLOC_MAX_ORDER)
+			return BITMAP_ERROR;
+
+	for (found = order; found <= PALLOC_MAX_ORDER; found++)
+		if (!list_empty (&pool->free_list[found]))
+			break;
+	if (found > PALLOC_MAX_ORDER)
+		return BITMAP_ERROR;
+
+	page_idx = block_idx (pool, list_front (&pool->free_list[found]));
+	block_remove (pool, page_idx, found);
+
+	/* Split down to ORDER, keeping the lower half each time. */
+	while (found > order) {
+		found--;
+		block_insert (pool, page_idx + ((size_t) 1 << found), found);
+	}
+
+	/* Give back the tail that the request does not need. */
+	block_cnt = (size_t) 1 << order;
+	ASSERT (bitmap_none (pool->used_map, page_idx, block_cnt));
+	bitmap_set_multiple (pool->used_map, page_idx, block_cnt, true);
+	if (block_cnt > page_cnt)
+		pool_free (pool, page_idx + page_cnt, block_cnt - page_cnt);
+	return page_idx;
+}
+
+/* Prints the free block counts of POOL, named NAME, by order. */
+static void
+pool_print_stats (struct pool *pool, const char *name) {
+	size_t free_pages = 0;
+	int order;
+
+	printf ("%s pool: free blocks by order:", name);
+	for (order = 0; order <= PALLOC_MAX_ORDER; order++) {
+		printf (" %zu", pool->free_cnt[order]);
+		free_pages += pool->free_cnt[order] << order;
+	}
+	printf (" (%zu pages free)\n", free_pages);
+}
+
+/* Prints page allocator statistics. */
+void
+palloc_print_stats (void) {
+	pool_print_stats (&kernel_pool, "Kernel");
+	pool_print_stats (&user_pool, "User");
+}
+
 /* Returns true if PAGE was allocated from POOL,
    false otherwise. */
 static bool
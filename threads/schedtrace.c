@@ -0,0 +1,188 @@
+/**
+ * NOTE: [Improve] 스케줄러 이벤트 추적
+ *
+ * 쓰레드 전환, block/unblock, priority donation, wakeup을 TSC 타임스탬프와 함께
+ * 고정 크기 링 버퍼에 기록하고, 우선순위별로 run queue 대기 시간과
+ * wakeup부터 실행까지의 지연 시간 히스토그램을 집계한다.
+ *
+ * 기록 위치는 원자적으로 증가시키는 인덱스로 예약하므로
+ * 인터럽트 핸들러 안에서도 락 없이 기록할 수 있다.
+ */
+
+#include "threads/schedtrace.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+/* 링 버퍼 크기 (2의 거듭제곱) */
+#define TRACE_SIZE 4096
+
+/* 히스토그램 구간 수. i번째 구간은 [2^i, 2^(i+1)) cycle */
+#define HIST_BUCKETS 48
+
+/* 링 버퍼의 이벤트 하나 */
+struct trace_entry
+{
+	uint64_t tsc;	/* 기록 시각 (TSC) */
+	uint8_t type;	/* enum sched_event */
+	uint8_t priority; /* 이벤트 당시 우선순위 */
+	int32_t tid;	/* 대상 쓰레드 */
+	int32_t arg;	/* 이벤트별 추가 정보 */
+};
+
+/* 우선순위 하나에 대한 지연 시간 히스토그램 */
+struct latency_hist
+{
+	uint64_t count;
+	uint64_t total;
+	uint64_t max;
+	uint32_t buckets[HIST_BUCKETS];
+};
+
+bool sched_trace_enabled;
+
+static struct trace_entry trace_buf[TRACE_SIZE];
+static uint64_t trace_head; /* 지금까지 기록된 이벤트 수 */
+
+static struct latency_hist wait_hist[PRI_MAX + 1];	 /* READY -> RUNNING */
+static struct latency_hist wakeup_hist[PRI_MAX + 1]; /* BLOCKED -> READY -> RUNNING */
+
+static void hist_add(struct latency_hist *, uint64_t cycles);
+static void hist_print(const char *name, struct latency_hist *);
+
+static const char *event_names[] = {"switch", "block", "unblock", "donate", "wakeup"};
+
+/**
+ * @brief 이벤트 하나를 링 버퍼에 기록하는 함수
+ *
+ * @param type 이벤트 종류
+ * @param tid 대상 쓰레드의 tid
+ * @param priority 이벤트 당시 대상 쓰레드의 우선순위
+ * @param arg 이벤트별 추가 정보 (전환 대상 tid, 기부받은 우선순위 등)
+ */
+void sched_trace_event(enum sched_event type, int tid, int priority, int arg)
+{
+	struct trace_entry *e;
+
+	if (!sched_trace_enabled)
+		return;
+
+	e = &trace_buf[__atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED) % TRACE_SIZE];
+	e->tsc = rdtsc();
+	e->type = type;
+	e->priority = priority;
+	e->tid = tid;
+	e->arg = arg;
+}
+
+/**
+ * @brief 쓰레드 T가 run queue에 들어간 시각을 기록하는 함수
+ *
+ * @param t run queue에 들어가는 쓰레드
+ * @param woken BLOCKED 상태에서 깨어난 경우 true, yield인 경우 false
+ */
+void sched_trace_ready(struct thread *t, bool woken)
+{
+	if (!sched_trace_enabled)
+		return;
+
+	t->ready_tsc = rdtsc();
+	t->woken = woken;
+}
+
+/**
+ * @brief 쓰레드 T가 CPU를 받은 시점에 대기 시간을 히스토그램에 반영하는 함수
+ * schedule()에서 인터럽트가 꺼진 상태로 호출된다.
+ *
+ * @param t 실행될 쓰레드
+ */
+void sched_trace_run(struct thread *t)
+{
+	uint64_t delta;
+
+	if (!sched_trace_enabled || t->ready_tsc == 0)
+		return;
+
+	delta = rdtsc() - t->ready_tsc;
+	hist_add(&wait_hist[t->priority], delta);
+	if (t->woken)
+		hist_add(&wakeup_hist[t->priority], delta);
+	t->ready_tsc = 0;
+}
+
+/* Prints scheduler latency histograms. */
+void sched_trace_print_stats(void)
+{
+	if (!sched_trace_enabled)
+		return;
+
+	printf("Sched trace: %llu events recorded\n", trace_head);
+	for (int pri = PRI_MAX; pri >= PRI_MIN; pri--)
+	{
+		if (wait_hist[pri].count == 0)
+			continue;
+		printf("  priority %d:\n", pri);
+		hist_print("run queue wait", &wait_hist[pri]);
+		hist_print("wakeup to run", &wakeup_hist[pri]);
+	}
+}
+
+/* Prints the most recent events in the trace buffer.
+   Used as the "sched-trace" action on the kernel command line. */
+void sched_trace_dump(char **argv UNUSED)
+{
+	enum intr_level old_level = intr_disable();
+	uint64_t head = trace_head;
+	uint64_t first = head > TRACE_SIZE ? head - TRACE_SIZE : 0;
+	intr_set_level(old_level);
+
+	printf("Sched trace dump: %llu of %llu events\n", head - first, head);
+	for (uint64_t i = first; i < head; i++)
+	{
+		struct trace_entry *e = &trace_buf[i % TRACE_SIZE];
+		printf("%20llu %-8s tid %d pri %d arg %d\n",
+			   e->tsc, event_names[e->type], e->tid, e->priority, e->arg);
+	}
+}
+
+/* CYCLES를 히스토그램 H에 추가 */
+static void hist_add(struct latency_hist *h, uint64_t cycles)
+{
+	int bucket = 63 - __builtin_clzll(cycles | 1);
+
+	if (bucket >= HIST_BUCKETS)
+		bucket = HIST_BUCKETS - 1;
+	h->count++;
+	h->total += cycles;
+	if (cycles > h->max)
+		h->max = cycles;
+	h->buckets[bucket]++;
+}
+
+/* 히스토그램 H를 NAME과 함께 출력. 99번째 백분위는 해당 구간의 상한으로 근사 */
+static void hist_print(const char *name, struct latency_hist *h)
+{
+	uint64_t seen = 0;
+	int p99 = 0;
+
+	if (h->count == 0)
+		return;
+
+	for (int i = 0; i < HIST_BUCKETS; i++)
+	{
+		seen += h->buckets[i];
+		if (seen * 100 >= h->count * 99)
+		{
+			p99 = i;
+			break;
+		}
+	}
+
+	printf("    %-15s n=%llu avg=%llu p99<%llu max=%llu cycles\n", name,
+		   h->count, h->total / h->count, 1ULL << (p99 + 1), h->max);
+	for (int i = 0; i < HIST_BUCKETS; i++)
+		if (h->buckets[i] != 0)
+			printf("      [2^%d, 2^%d) %u\n", i, i + 1, h->buckets[i]);
+}
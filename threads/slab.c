@@ -0,0 +1,218 @@
+#include "threads/slab.h"
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+/* An object cache allocator.
+
+   malloc() rounds every request up to a power of 2, so a 40-byte
+   object occupies a 64-byte block.  Subsystems that allocate
+   many objects of one type can instead set up a "cache" for it
+   with slab_cache_init().  A cache carves page-sized "slabs"
+   into objects of exactly its (8-byte aligned) object size.
+
+   Each slab starts with a header that records its cache and a
+   stack of the indexes of its free objects; the objects fill the
+   rest of the page.  Because the free list lives in the header,
+   a free object is never written to, so an object handed back
+   with slab_free() keeps the state its constructor gave it when
+   the slab was created, as in Bonwick's slab allocator.
+
+   A cache keeps slabs with free objects on its PARTIAL list and
+   the rest on its FULL list, so both allocation and freeing take
+   constant time.  One completely free slab is kept to absorb
+   alloc/free bursts; further ones go back to the page
+   allocator.
+
+   Like the page allocator, a cache holds its spinlock with
+   interrupts off, only around those constant-time list and stack
+   operations, so objects can be freed from inside the scheduler.
+   New slabs are built, and their objects constructed, outside
+   the lock. */
+
+/* Magic number for detecting slab corruption. */
+#define SLAB_MAGIC 0x51ab51ab
+
+/* Slab header, at the start of each slab page. */
+struct slab {
+	unsigned magic;             /* Always set to SLAB_MAGIC. */
+	struct slab_cache *cache;   /* Owning cache. */
+	struct list_elem elem;      /* Element in PARTIAL or FULL. */
+	size_t free_top;            /* Number of entries in FREE_IDX. */
+	uint8_t *objs;              /* First object. */
+	uint16_t free_idx[];        /* Stack of free object indexes. */
+};
+
+/* List of all caches, for statistics. */
+static struct list cache_list;
+
+/* Initializes the object cache allocator. */
+void
+slab_init (void) {
+	list_init (&cache_list);
+}
+
+/* Initializes cache C, named NAME, for objects of SIZE bytes.
+   If CTOR is non-null, it is called on every object once, when
+   the slab that holds the object is created; objects passed to
+   slab_free() must be returned in their constructed state. */
+void
+slab_cache_init (struct slab_cache *c, const char *name, size_t size,
+		void (*ctor) (void *)) {
+	size_t n;
+
+	ASSERT (size > 0);
+
+	c->name = name;
+	c->obj_size = ROUND_UP (size, sizeof (void *));
+	c->ctor = ctor;
+
+	/* Fit as many objects as possible next to the header. */
+	for (n = (PGSIZE - sizeof (struct slab)) / c->obj_size; n > 0; n--) {
+		size_t hdr = ROUND_UP (sizeof (struct slab) + n * sizeof (uint16_t),
+				sizeof (void *));
+		if (hdr + n * c->obj_size <= PGSIZE)
+			break;
+	}
+	ASSERT (n > 0);
+	c->objs_per_slab = n;
+
+	spinlock_init_named (&c->lock, name);
+	list_init (&c->partial);
+	list_init (&c->full);
+	c->empty_cnt = 0;
+	c->slab_cnt = c->in_use = 0;
+	c->alloc_cnt = c->grow_cnt = c->shrink_cnt = 0;
+	list_push_back (&cache_list, &c->elem);
+}
+
+/* Obtains a new slab for C and constructs its objects.  The
+   caller must put it on C's PARTIAL list.  Returns a null pointer
+   if no page is available. */
+static struct slab *
+cache_grow (struct slab_cache *c) {
+	struct slab *s = palloc_get_page (0);
+	size_t i;
+
+	if (s == NULL)
+		return NULL;
+
+	s->magic = SLAB_MAGIC;
+	s->cache = c;
+	s->objs = (uint8_t *) s + ROUND_UP (sizeof *s
+			+ c->objs_per_slab * sizeof (uint16_t), sizeof (void *));
+	s->free_top = c->objs_per_slab;
+	for (i = 0; i < c->objs_per_slab; i++) {
+		/* Hand out the lowest addresses first. */
+		s->free_idx[i] = c->objs_per_slab - 1 - i;
+		if (c->ctor != NULL)
+			c->ctor (s->objs + i * c->obj_size);
+	}
+
+	return s;
+}
+
+/* Returns an object from cache C, or a null pointer if no memory
+   is available. */
+void *
+slab_alloc (struct slab_cache *c) {
+	struct slab *s;
+	void *obj;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	spinlock_acquire (&c->lock);
+	if (list_empty (&c->partial)) {
+		spinlock_release (&c->lock);
+		intr_set_level (old_level);
+
+		s = cache_grow (c);
+		if (s == NULL)
+			return NULL;
+
+		old_level = intr_disable ();
+		spinlock_acquire (&c->lock);
+		list_push_front (&c->partial, &s->elem);
+		c->empty_cnt++;
+		c->slab_cnt++;
+		c->grow_cnt++;
+	}
+
+	s = list_entry (list_front (&c->partial), struct slab, elem);
+	if (s->free_top == c->objs_per_slab)
+		c->empty_cnt--;
+	obj = s->objs + s->free_idx[--s->free_top] * c->obj_size;
+	if (s->free_top == 0) {
+		list_remove (&s->elem);
+		list_push_front (&c->full, &s->elem);
+	}
+	c->in_use++;
+	c->alloc_cnt++;
+	spinlock_release (&c->lock);
+	intr_set_level (old_level);
+
+	return obj;
+}
+
+/* Returns OBJ, which must have come from slab_alloc(C), to C.
+   A null OBJ is ignored. */
+void
+slab_free (struct slab_cache *c, void *obj) {
+	struct slab *s;
+	size_t idx;
+	enum intr_level old_level;
+
+	if (obj == NULL)
+		return;
+
+	s = pg_round_down (obj);
+	ASSERT (s->magic == SLAB_MAGIC);
+	ASSERT (s->cache == c);
+	idx = ((uint8_t *) obj - s->objs) / c->obj_size;
+	ASSERT (idx < c->objs_per_slab);
+	ASSERT (s->objs + idx * c->obj_size == obj);
+
+	old_level = intr_disable ();
+	spinlock_acquire (&c->lock);
+	ASSERT (s->free_top < c->objs_per_slab);
+	if (s->free_top == 0) {
+		/* Was full: move it back so it gets allocated from. */
+		list_remove (&s->elem);
+		list_push_front (&c->partial, &s->elem);
+	}
+	s->free_idx[s->free_top++] = idx;
+	c->in_use--;
+
+	if (s->free_top == c->objs_per_slab) {
+		if (c->empty_cnt > 0) {
+			/* Already holding a free slab: give this one back. */
+			list_remove (&s->elem);
+			s->magic = 0;
+			palloc_free_page (s);
+			c->slab_cnt--;
+			c->shrink_cnt++;
+		} else
+			c->empty_cnt++;
+	}
+	spinlock_release (&c->lock);
+	intr_set_level (old_level);
+}
+
+/* Prints object cache statistics. */
+void
+slab_print_stats (void) {
+	struct list_elem *e;
+
+	for (e = list_begin (&cache_list); e != list_end (&cache_list);
+			e = list_next (e)) {
+		struct slab_cache *c = list_entry (e, struct slab_cache, elem);
+		printf ("Slab %s: %zu-byte objects, %zu in use, %zu slabs, "
+				"%lld allocs, %lld grows, %lld shrinks\n",
+				c->name, c->obj_size, c->in_use, c->slab_cnt,
+				c->alloc_cnt, c->grow_cnt, c->shrink_cnt);
+	}
+}
@@ -27,12 +27,91 @@
    */
 
 #include "threads/synch.h"
+#include <hash.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/schedtrace.h"
+#include "intrinsic.h"
+
+static struct thread *waiter_heap_meld(struct thread *a, struct thread *b);
+static struct thread *waiter_heap_merge_pairs(struct thread *first);
+static void waiter_heap_detach(struct thread *t);
+static void waiter_heap_remove(struct thread **heap, struct thread *t);
+static void waiter_heap_insert(struct thread **heap, struct thread *t);
+static struct thread *waiter_heap_pop(struct thread **heap);
+static struct lock_class *lockstat_lookup(const char *name, enum lock_class_type type);
+static inline struct lock_class *lockstat_class(struct lock_class **class, const char *name, enum lock_class_type type);
+static void lockstat_wait(struct lock_class *class, bool contended, uint64_t start);
+static void lockstat_hold(struct lock_class *class, uint64_t *acquire_tsc);
+static void donate_to(struct thread *holder, int priority, int depth);
+static void rwlock_donate(struct rwlock *rw, int priority, int depth);
+static int rwlock_max_waiter_priority(const struct rwlock *rw);
+
+/* NOTE: [Improve] 스핀락 LOCK을 초기화 */
+void spinlock_init_named(struct spinlock *lock, const char *name)
+{
+	ASSERT(lock != NULL);
+	lock->locked = 0;
+	lock->name = name;
+	lock->class = NULL;
+	lock->acquire_tsc = 0;
+}
+
+/**
+ * @brief 스핀락을 획득할 때까지 busy-wait 하는 함수
+ * 같은 CPU에서 인터럽트 핸들러가 같은 락을 잡으려다 교착되지 않도록
+ * 인터럽트가 비활성화된 상태에서 호출되어야 한다.
+ *
+ * @param lock 획득할 스핀락
+ */
+void spinlock_acquire(struct spinlock *lock)
+{
+	struct lock_class *class;
+	uint64_t start = 0;
+	bool contended = false;
 
-static bool cmp_priority_donation(const struct list_elem *a_, const struct list_elem *b_, void *aux UNUSED);
+	ASSERT(lock != NULL);
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	class = lockstat_class(&lock->class, lock->name, LOCK_CLASS_SPIN);
+	if (class != NULL)
+		start = rdtsc();
+	while (__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE))
+	{
+		contended = true;
+		while (lock->locked)
+			asm volatile("pause");
+	}
+	lockstat_wait(class, contended, start);
+	if (class != NULL)
+		lock->acquire_tsc = rdtsc();
+}
+
+/* NOTE: [Improve] 기다리지 않고 스핀락 획득을 시도. 성공 여부 리턴 */
+bool spinlock_try_acquire(struct spinlock *lock)
+{
+	ASSERT(lock != NULL);
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (__atomic_exchange_n(&lock->locked, 1, __ATOMIC_ACQUIRE))
+		return false;
+	lockstat_wait(lockstat_class(&lock->class, lock->name, LOCK_CLASS_SPIN), false, 0);
+	if (lock->class != NULL && lockstat_enabled)
+		lock->acquire_tsc = rdtsc();
+	return true;
+}
+
+/* NOTE: [Improve] 스핀락을 놓아준다. */
+void spinlock_release(struct spinlock *lock)
+{
+	ASSERT(lock != NULL);
+	ASSERT(lock->locked);
+
+	lockstat_hold(lock->class, &lock->acquire_tsc);
+	__atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -42,12 +121,18 @@ static bool cmp_priority_donation(const struct list_elem *a_, const struct list_
    decrement it.
 
    - up or "V": increment the value (and wake up one waiting
-   thread, if any). */
-void sema_init(struct semaphore *sema, unsigned value)
+   thread, if any).
+
+   NAME identifies SEMA in the lockstat report, or is a null
+   pointer if SEMA should not be counted.  The sema_init() macro
+   passes the argument expression itself as NAME. */
+void sema_init_named(struct semaphore *sema, unsigned value, const char *name)
 {
 	ASSERT(sema != NULL);
 	sema->value = value;
-	list_init(&sema->waiters);
+	sema->waiters = NULL;
+	sema->name = name;
+	sema->class = NULL;
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -61,18 +146,24 @@ void sema_init(struct semaphore *sema, unsigned value)
 void sema_down(struct semaphore *sema)
 {
 	enum intr_level old_level;
+	uint64_t start = 0;
+	bool contended;
 
 	ASSERT(sema != NULL);
 	ASSERT(!intr_context());
 
 	old_level = intr_disable();
+	contended = sema->value == 0;
+	if (lockstat_class(&sema->class, sema->name, LOCK_CLASS_SEMA) != NULL)
+		start = rdtsc();
 	while (sema->value == 0)
 	{
-		// list_push_back(&sema->waiters, &thread_current()->elem);
-		list_insert_ordered(&sema->waiters, &thread_current()->elem, compare_priority, 0);
+		/* NOTE: [Improve] 대기자 heap에 넣어두면 sema_up은 루트만 꺼내면 된다. */
+		waiter_heap_insert(&sema->waiters, thread_current());
 		thread_block();
 	}
 	sema->value--;
+	lockstat_wait(sema->class, contended, start);
 	intr_set_level(old_level);
 }
 
@@ -93,6 +184,7 @@ bool sema_try_down(struct semaphore *sema)
 	{
 		sema->value--;
 		success = true;
+		lockstat_wait(lockstat_class(&sema->class, sema->name, LOCK_CLASS_SEMA), false, 0);
 	}
 	else
 		success = false;
@@ -112,12 +204,8 @@ void sema_up(struct semaphore *sema)
 	ASSERT(sema != NULL);
 
 	old_level = intr_disable();
-	if (!list_empty(&sema->waiters))
-	{
-		list_sort(&sema->waiters, compare_priority, 0);
-		thread_unblock(list_entry(list_pop_front(&sema->waiters),
-								  struct thread, elem));
-	}
+	if (sema->waiters != NULL)
+		thread_unblock(waiter_heap_pop(&sema->waiters));
 	sema->value++;
 	thread_compare_yield();
 	intr_set_level(old_level);
@@ -173,13 +261,20 @@ sema_test_helper(void *sema_)
    another one "up" it, but with a lock the same thread must both
    acquire and release it.  When these restrictions prove
    onerous, it's a good sign that a semaphore should be used,
-   instead of a lock. */
-void lock_init(struct lock *lock)
+   instead of a lock.
+
+   NAME identifies LOCK in the lockstat report, or is a null
+   pointer if LOCK should not be counted.  The lock_init() macro
+   passes the argument expression itself as NAME. */
+void lock_init_named(struct lock *lock, const char *name)
 {
 	ASSERT(lock != NULL);
 
 	lock->holder = NULL;
-	sema_init(&lock->semaphore, 1);
+	sema_init_named(&lock->semaphore, 1, NULL);
+	lock->name = name;
+	lock->class = NULL;
+	lock->acquire_tsc = 0;
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -192,51 +287,79 @@ void lock_init(struct lock *lock)
    we need to sleep. */
 void lock_acquire(struct lock *lock)
 {
+	enum intr_level old_level;
+
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(!lock_held_by_current_thread(lock));
 
 	struct thread *curr = thread_current();
-	struct thread *lock_holder_t = lock->holder;
+	uint64_t start = 0;
+	bool contended;
 
-	if (lock->holder != NULL)
+	/* NOTE: [Improve] holder 쪽으로 우선순위 기부
+	   대기자 heap은 lock->semaphore의 것을 그대로 쓴다. */
+	old_level = intr_disable();
+	contended = lock->holder != NULL;
+	if (lockstat_class(&lock->class, lock->name, LOCK_CLASS_LOCK) != NULL)
+		start = rdtsc();
+	if (lock->holder != NULL && !thread_mlfqs)
 	{
 		curr->wait_on_lock = lock;
-		list_insert_ordered(&lock_holder_t->donations, &curr->donation_elem, cmp_donation, 0);
 
 		// donate-nest passed
-		if (!thread_mlfqs)
-			donate_priority();
-
-		// donate-one passed
-		// if(lock_holder_t->priority < curr->priority){
-		// 	lock_holder_t->priority = curr->priority;
-		// }
+		donate_priority();
 	}
 
 	sema_down(&lock->semaphore);
+
+	/* 이제 holder로서 lock을 보유 목록에 추가 */
 	curr->wait_on_lock = NULL;
-	lock->holder = thread_current();
+	lock->holder = curr;
+	list_push_back(&curr->held_locks, &lock->elem);
+	lockstat_wait(lock->class, contended, start);
+	if (lockstat_enabled && lock->class != NULL)
+		lock->acquire_tsc = rdtsc();
+	intr_set_level(old_level);
 }
 
+/* NOTE: 현재 쓰레드의 우선순위를 기다리는 lock의 holder에게 기부
+   인터럽트가 비활성화된 상태에서 호출되어야 한다. */
 void donate_priority(void)
 {
-	int depth;
 	struct thread *cur = thread_current();
 
-	for (depth = 0; depth < 8; depth++)
-	{
-		if (!cur->wait_on_lock)
-			break;
-		struct thread *holder = cur->wait_on_lock->holder;
-		holder->priority = cur->priority;
-		cur = holder;
-	}
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (cur->wait_on_lock != NULL && cur->wait_on_lock->holder != NULL)
+		donate_to(cur->wait_on_lock->holder, cur->priority, 0);
 }
 
-bool cmp_donation(struct list_elem *a, struct list_elem *b, void *aux UNUSED)
+/**
+ * @brief HOLDER에게 PRIORITY를 기부하고, HOLDER가 기다리는 lock/rwlock의 보유자들에게 이어서 전파하는 함수
+ *
+ * holder의 우선순위가 이미 기부할 우선순위 이상이면, 그 뒤의 holder들도
+ * 이미 기부를 받은 상태이므로 전파를 멈춘다. 기부를 받은 holder가
+ * semaphore/lock/condition/rwlock을 기다리는 중이라면 thread_change_priority()가
+ * 그 대기자 heap에서 자리를 다시 잡아준다.
+ * 전파 깊이는 8로 제한한다.
+ *
+ * @param holder 기부받을 쓰레드
+ * @param priority 기부할 우선순위
+ * @param depth 현재 전파 깊이
+ */
+static void donate_to(struct thread *holder, int priority, int depth)
 {
-	return list_entry(a, struct thread, donation_elem)->priority > list_entry(b, struct thread, donation_elem)->priority;
+	if (depth >= 8 || holder->priority >= priority)
+		return;
+
+	sched_trace_event(SCHED_DONATE, holder->tid, holder->priority, priority);
+	thread_change_priority(holder, priority);
+
+	if (holder->wait_on_lock != NULL && holder->wait_on_lock->holder != NULL)
+		donate_to(holder->wait_on_lock->holder, priority, depth + 1);
+	else if (holder->wait_on_rwlock != NULL)
+		rwlock_donate(holder->wait_on_rwlock, priority, depth + 1);
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -247,14 +370,23 @@ bool cmp_donation(struct list_elem *a, struct list_elem *b, void *aux UNUSED)
    interrupt handler. */
 bool lock_try_acquire(struct lock *lock)
 {
+	enum intr_level old_level;
 	bool success;
 
 	ASSERT(lock != NULL);
 	ASSERT(!lock_held_by_current_thread(lock));
 
+	old_level = intr_disable();
 	success = sema_try_down(&lock->semaphore);
 	if (success)
+	{
 		lock->holder = thread_current();
+		list_push_back(&lock->holder->held_locks, &lock->elem);
+		lockstat_wait(lockstat_class(&lock->class, lock->name, LOCK_CLASS_LOCK), false, 0);
+		if (lockstat_enabled && lock->class != NULL)
+			lock->acquire_tsc = rdtsc();
+	}
+	intr_set_level(old_level);
 	return success;
 }
 
@@ -266,57 +398,429 @@ bool lock_try_acquire(struct lock *lock)
    handler. */
 void lock_release(struct lock *lock)
 {
+	enum intr_level old_level;
+
 	ASSERT(lock != NULL);
 	ASSERT(lock_held_by_current_thread(lock));
+
+	old_level = intr_disable();
+	lockstat_hold(lock->class, &lock->acquire_tsc);
+	list_remove(&lock->elem);
 	if (!thread_mlfqs)
-	{
-		remove_donations(lock);
 		update_donate_priority();
-		// donate-one passed
-		// lock->holder->priority = lock->holder->origin_priority;
-	}
 
 	lock->holder = NULL;
 	sema_up(&lock->semaphore);
+	intr_set_level(old_level);
 }
 
-void remove_donations(struct lock *lock)
+/**
+ * @brief 현재 쓰레드의 우선순위를 원래 우선순위와 보유 중인 lock들의 최고 대기자 우선순위 중 최대값으로 갱신하는 함수
+ * 각 lock의 최고 대기자는 heap의 루트이므로 보유 lock 하나당 O(1)이다.
+ */
+void update_donate_priority(void)
+{
+	struct thread *curr = thread_current();
+	struct list_elem *e;
+	enum intr_level old_level;
+	int priority = curr->origin_priority;
+
+	old_level = intr_disable();
+	for (e = list_begin(&curr->held_locks); e != list_end(&curr->held_locks); e = list_next(e))
+	{
+		struct thread *top = list_entry(e, struct lock, elem)->semaphore.waiters;
+		if (top != NULL && top->priority > priority)
+			priority = top->priority;
+	}
+	for (int i = 0; i < RWLOCK_HOLD_MAX; i++)
+	{
+		struct rwlock *rw = curr->ext->rw_holds[i].rwlock;
+		if (rw != NULL && rwlock_max_waiter_priority(rw) > priority)
+			priority = rwlock_max_waiter_priority(rw);
+	}
+	/* cond_wait()은 대기자 heap에 들어간 뒤 lock을 놓으므로, 여기서 낮아진 우선순위도 heap에 반영해야 함 */
+	thread_change_priority(curr, priority);
+	intr_set_level(old_level);
+}
+
+/**
+ * @brief 두 대기자 heap을 하나로 합치는 함수 (우선순위 기준 max-heap)
+ * 우선순위가 높은 쪽이 루트가 되고, 다른 쪽은 루트의 첫 번째 자식이 된다.
+ * 우선순위가 같으면 먼저 기다리기 시작한 쪽(wait_seq가 작은 쪽)이 루트가 되어 FIFO 순서를 지킨다.
+ * 두 루트 모두 다른 heap에서 떨어져 나온 상태(형제/부모 없음)여야 한다.
+ *
+ * @param a 첫 번째 heap의 루트 (NULL 가능)
+ * @param b 두 번째 heap의 루트 (NULL 가능)
+ * @return struct thread* 합쳐진 heap의 루트
+ */
+static struct thread *waiter_heap_meld(struct thread *a, struct thread *b)
 {
-	struct thread *lock_holder_t = lock->holder;
+	struct thread *tmp;
 
-	struct list_elem *remove_elem = list_begin(&lock_holder_t->donations);
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
 
-	while (remove_elem != list_end(&lock_holder_t->donations))
+	if (b->priority > a->priority || (b->priority == a->priority && b->wait_seq < a->wait_seq))
 	{
-		struct thread *remove_t = list_entry(remove_elem, struct thread, donation_elem);
-		if (remove_t->wait_on_lock == lock)
+		tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	b->waiter_sibling = a->waiter_child;
+	if (a->waiter_child != NULL)
+		a->waiter_child->waiter_prev = b;
+	b->waiter_prev = a;
+	a->waiter_child = b;
+	return a;
+}
+
+/* NOTE: [Improve] FIRST부터 이어지는 형제들을 two-pass로 합쳐 하나의 heap으로 만듦 */
+static struct thread *waiter_heap_merge_pairs(struct thread *first)
+{
+	struct thread *pairs = NULL;
+	struct thread *a, *b, *next, *root;
+
+	/* 1st pass: 두 개씩 합쳐 역순 리스트(pairs)에 쌓음 */
+	a = first;
+	while (a != NULL)
+	{
+		b = a->waiter_sibling;
+		next = b != NULL ? b->waiter_sibling : NULL;
+		a->waiter_sibling = a->waiter_prev = NULL;
+		if (b != NULL)
+			b->waiter_sibling = b->waiter_prev = NULL;
+
+		a = waiter_heap_meld(a, b);
+		a->waiter_sibling = pairs;
+		pairs = a;
+		a = next;
+	}
+
+	/* 2nd pass: 오른쪽부터 하나의 heap으로 합침 */
+	root = NULL;
+	while (pairs != NULL)
+	{
+		next = pairs->waiter_sibling;
+		pairs->waiter_sibling = NULL;
+		root = waiter_heap_meld(root, pairs);
+		pairs = next;
+	}
+	return root;
+}
+
+/* NOTE: [Improve] 루트가 아닌 T를 (자식들은 그대로 둔 채) 부모/형제로부터 떼어냄 */
+static void waiter_heap_detach(struct thread *t)
+{
+	if (t->waiter_prev->waiter_child == t)
+		t->waiter_prev->waiter_child = t->waiter_sibling;
+	else
+		t->waiter_prev->waiter_sibling = t->waiter_sibling;
+	if (t->waiter_sibling != NULL)
+		t->waiter_sibling->waiter_prev = t->waiter_prev;
+	t->waiter_sibling = t->waiter_prev = NULL;
+}
+
+/* NOTE: [Improve] 대기자 heap HEAP에서 T를 제거 */
+static void waiter_heap_remove(struct thread **heap, struct thread *t)
+{
+	struct thread *children = t->waiter_child;
+
+	t->waiter_child = NULL;
+	t->wait_heap = NULL;
+	if (*heap == t)
+		*heap = waiter_heap_merge_pairs(children);
+	else
+	{
+		waiter_heap_detach(t);
+		*heap = waiter_heap_meld(*heap, waiter_heap_merge_pairs(children));
+	}
+}
+
+/**
+ * @brief 우선순위가 바뀐 T를 들어가 있는 대기자 heap에서 다시 자리잡게 하는 함수
+ * 우선순위가 내려갔으면 T의 자식들이 T보다 높을 수 있으므로 T를 빼냈다가 다시 넣는다.
+ * wait_seq는 그대로 두어 같은 우선순위 사이의 FIFO 순서를 유지한다.
+ * 인터럽트가 비활성화된 상태에서 호출되어야 한다.
+ *
+ * @param t 우선순위가 바뀐 쓰레드 (대기자 heap에 없으면 아무것도 하지 않음)
+ */
+void waiter_heap_update(struct thread *t)
+{
+	struct thread **heap = t->wait_heap;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	if (heap == NULL)
+		return;
+	waiter_heap_remove(heap, t);
+	t->wait_heap = heap;
+	*heap = waiter_heap_meld(*heap, t);
+}
+
+/* NOTE: [Improve] T를 대기자 heap HEAP에 넣음. 먼저 들어온 순서를 wait_seq로 기록 */
+static void waiter_heap_insert(struct thread **heap, struct thread *t)
+{
+	static uint64_t wait_seq;
+
+	ASSERT(intr_get_level() == INTR_OFF);
+	ASSERT(t->wait_heap == NULL);
+
+	t->wait_seq = wait_seq++;
+	t->wait_heap = heap;
+	*heap = waiter_heap_meld(*heap, t);
+}
+
+/* NOTE: [Improve] 대기자 heap HEAP의 루트(가장 높은 우선순위의 대기자)를 꺼냄 */
+static struct thread *waiter_heap_pop(struct thread **heap)
+{
+	struct thread *t = *heap;
+
+	waiter_heap_remove(heap, t);
+	return t;
+}
+
+/* NOTE: [Improve] Reader-writer lock.
+
+   여러 reader가 동시에 보유하거나, 하나의 writer만 단독으로 보유할 수 있는 lock.
+   writer가 기다리고 있으면 새로 오는 reader도 기다리게 하여(writer preference)
+   writer가 굶지 않도록 한다.  lock을 놓을 때는 다음 보유자를 직접 정해서
+   깨우므로(hand-off), 깨어난 쓰레드는 조건을 다시 확인할 필요가 없다.
+
+   기다리는 쓰레드는 모든 보유자(writer 또는 모든 reader)에게 우선순위를 기부한다.
+   이를 위해 각 쓰레드는 보유 중인 rwlock을 rw_holds에 기록한다. */
+
+static struct rwlock_hold *rwlock_hold_add(struct rwlock *rw, struct thread *t);
+static void rwlock_hold_remove(struct rwlock *rw, struct thread *t);
+static void rwlock_wait(struct rwlock *rw, struct thread **heap);
+static struct thread *rwlock_pop_waiter(struct thread **heap);
+static void rwlock_wake_next(struct rwlock *rw);
+
+/* Initializes RW as an unheld reader-writer lock. */
+void rwlock_init(struct rwlock *rw)
+{
+	ASSERT(rw != NULL);
+
+	rw->writer = NULL;
+	rw->readers = 0;
+	list_init(&rw->holders);
+	rw->read_heap = NULL;
+	rw->write_heap = NULL;
+}
+
+/* Acquires RW for shared (read) access, sleeping while a writer
+   holds it or is waiting for it.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void rwlock_acquire_read(struct rwlock *rw)
+{
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+	ASSERT(!rwlock_held_by_current_thread(rw));
+
+	old_level = intr_disable();
+	if (rw->writer == NULL && rw->write_heap == NULL)
+	{
+		rw->readers++;
+		rwlock_hold_add(rw, thread_current());
+	}
+	else
+		rwlock_wait(rw, &rw->read_heap);
+	intr_set_level(old_level);
+}
+
+/* Acquires RW for exclusive (write) access, sleeping until no
+   other thread holds it.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void rwlock_acquire_write(struct rwlock *rw)
+{
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(!intr_context());
+	ASSERT(!rwlock_held_by_current_thread(rw));
+
+	old_level = intr_disable();
+	if (rw->writer == NULL && rw->readers == 0)
+	{
+		rw->writer = thread_current();
+		rwlock_hold_add(rw, rw->writer);
+	}
+	else
+		rwlock_wait(rw, &rw->write_heap);
+	intr_set_level(old_level);
+}
+
+/* Releases shared access to RW, which the current thread must
+   hold for reading.  The last reader hands RW to the
+   highest-priority waiting writer. */
+void rwlock_release_read(struct rwlock *rw)
+{
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(rw->writer == NULL && rw->readers > 0);
+
+	old_level = intr_disable();
+	rwlock_hold_remove(rw, thread_current());
+	if (--rw->readers == 0)
+		rwlock_wake_next(rw);
+	if (!thread_mlfqs)
+		update_donate_priority();
+	thread_compare_yield();
+	intr_set_level(old_level);
+}
+
+/* Releases exclusive access to RW, which the current thread must
+   hold for writing.  RW is handed to the highest-priority waiting
+   writer if there is one, otherwise to every waiting reader. */
+void rwlock_release_write(struct rwlock *rw)
+{
+	enum intr_level old_level;
+
+	ASSERT(rw != NULL);
+	ASSERT(rw->writer == thread_current());
+
+	old_level = intr_disable();
+	rwlock_hold_remove(rw, rw->writer);
+	rw->writer = NULL;
+	rwlock_wake_next(rw);
+	if (!thread_mlfqs)
+		update_donate_priority();
+	thread_compare_yield();
+	intr_set_level(old_level);
+}
+
+/* Returns true if the current thread holds RW for reading or
+   writing, false otherwise. */
+bool rwlock_held_by_current_thread(const struct rwlock *rw)
+{
+	struct thread *curr = thread_current();
+
+	ASSERT(rw != NULL);
+
+	for (int i = 0; i < RWLOCK_HOLD_MAX; i++)
+		if (curr->ext->rw_holds[i].rwlock == rw)
+			return true;
+	return false;
+}
+
+/* NOTE: [Improve] T가 RW를 보유함을 기록 (T의 rw_holds 빈 칸 사용) */
+static struct rwlock_hold *rwlock_hold_add(struct rwlock *rw, struct thread *t)
+{
+	for (int i = 0; i < RWLOCK_HOLD_MAX; i++)
+	{
+		struct rwlock_hold *hold = &t->ext->rw_holds[i];
+		if (hold->rwlock == NULL)
 		{
-			remove_elem = list_remove(&remove_t->donation_elem);
+			hold->rwlock = rw;
+			hold->thread = t;
+			list_push_back(&rw->holders, &hold->elem);
+			return hold;
 		}
-		else
+	}
+	PANIC("thread %s holds too many rwlocks", t->name);
+}
+
+/* NOTE: [Improve] T의 RW 보유 기록을 삭제 */
+static void rwlock_hold_remove(struct rwlock *rw, struct thread *t)
+{
+	for (int i = 0; i < RWLOCK_HOLD_MAX; i++)
+	{
+		struct rwlock_hold *hold = &t->ext->rw_holds[i];
+		if (hold->rwlock == rw)
 		{
-			remove_elem = list_next(remove_elem);
+			list_remove(&hold->elem);
+			hold->rwlock = NULL;
+			return;
 		}
 	}
+	NOT_REACHED();
 }
 
-void update_donate_priority(void)
+/**
+ * @brief 현재 쓰레드를 RW의 대기자로 등록하고, 보유자들에게 우선순위를 기부한 뒤 잠드는 함수
+ * 깨어났을 때는 이미 깨운 쪽에서 RW를 넘겨준 상태이다.
+ *
+ * @param rw 기다릴 rwlock
+ * @param heap 들어갈 대기자 heap (read_heap 또는 write_heap)
+ */
+static void rwlock_wait(struct rwlock *rw, struct thread **heap)
 {
 	struct thread *curr = thread_current();
 
-	curr->priority = curr->origin_priority;
-	// why? = curr < list's priority consider
+	curr->wait_on_rwlock = rw;
+	waiter_heap_insert(heap, curr);
+	if (!thread_mlfqs)
+		rwlock_donate(rw, curr->priority, 0);
+	thread_block();
+}
 
-	if (!list_empty(&curr->donations))
-	{
-		list_sort(&curr->donations, cmp_donation, 0);
-		struct thread *donate_t = list_entry(list_begin(&curr->donations), struct thread, donation_elem);
+/* NOTE: [Improve] HEAP에서 가장 높은 우선순위의 쓰레드 (같으면 먼저 온 쓰레드)를 꺼내 대기 상태를 정리 */
+static struct thread *rwlock_pop_waiter(struct thread **heap)
+{
+	struct thread *t = waiter_heap_pop(heap);
+
+	t->wait_on_rwlock = NULL;
+	return t;
+}
 
-		if (curr->priority < donate_t->priority)
+/**
+ * @brief RW가 비었을 때 다음 보유자를 정해 깨우는 함수
+ * 기다리는 writer가 있으면 그중 가장 높은 우선순위의 writer에게, 없으면 모든 reader에게 넘긴다.
+ * 남은 대기자들의 우선순위는 새 보유자들에게 다시 기부한다.
+ */
+static void rwlock_wake_next(struct rwlock *rw)
+{
+	ASSERT(rw->writer == NULL && rw->readers == 0);
+
+	if (rw->write_heap != NULL)
+	{
+		rw->writer = rwlock_pop_waiter(&rw->write_heap);
+		rwlock_hold_add(rw, rw->writer);
+		thread_unblock(rw->writer);
+	}
+	else
+	{
+		while (rw->read_heap != NULL)
 		{
-			curr->priority = donate_t->priority;
+			struct thread *t = rwlock_pop_waiter(&rw->read_heap);
+			rw->readers++;
+			rwlock_hold_add(rw, t);
+			thread_unblock(t);
 		}
 	}
+
+	if (!thread_mlfqs && rwlock_max_waiter_priority(rw) >= PRI_MIN)
+		rwlock_donate(rw, rwlock_max_waiter_priority(rw), 0);
+}
+
+/* NOTE: [Improve] RW의 모든 보유자에게 PRIORITY를 기부 */
+static void rwlock_donate(struct rwlock *rw, int priority, int depth)
+{
+	struct list_elem *e;
+
+	for (e = list_begin(&rw->holders); e != list_end(&rw->holders); e = list_next(e))
+		donate_to(list_entry(e, struct rwlock_hold, elem)->thread, priority, depth);
+}
+
+/* NOTE: [Improve] RW를 기다리는 쓰레드 중 가장 높은 우선순위 (없으면 PRI_MIN - 1) */
+static int rwlock_max_waiter_priority(const struct rwlock *rw)
+{
+	int priority = PRI_MIN - 1;
+
+	if (rw->read_heap != NULL)
+		priority = rw->read_heap->priority;
+	if (rw->write_heap != NULL && rw->write_heap->priority > priority)
+		priority = rw->write_heap->priority;
+	return priority;
 }
 
 /* Returns true if the current thread holds LOCK, false
@@ -329,13 +833,6 @@ bool lock_held_by_current_thread(const struct lock *lock)
 	return lock->holder == thread_current();
 }
 
-/* One semaphore in a list. */
-struct semaphore_elem
-{
-	struct list_elem elem;		/* List element. */
-	struct semaphore semaphore; /* This semaphore. */
-};
-
 /* Initializes condition variable COND.  A condition variable
    allows one piece of  code to signal a condition and cooperating
    code to receive the signal and act upon it. */
@@ -343,7 +840,7 @@ void cond_init(struct condition *cond)
 {
 	ASSERT(cond != NULL);
 
-	list_init(&cond->waiters);
+	cond->waiters = NULL;
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -368,37 +865,25 @@ void cond_init(struct condition *cond)
    we need to sleep. */
 void cond_wait(struct condition *cond, struct lock *lock)
 {
-	struct semaphore_elem waiter;
+	struct thread *curr = thread_current();
+	enum intr_level old_level;
 
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(lock_held_by_current_thread(lock));
 
-	sema_init(&waiter.semaphore, 0);
-	list_push_back(&cond->waiters, &waiter.elem);
+	/* NOTE: [Improve] 쓰레드마다 semaphore를 두는 대신 COND의 대기자 heap에 직접 들어간다.
+	   lock_release 안에서 양보한 사이에 이미 signal을 받았다면 (heap에서 빠졌다면) 잠들지 않는다. */
+	old_level = intr_disable();
+	waiter_heap_insert(&cond->waiters, curr);
 	lock_release(lock);
-	sema_down(&waiter.semaphore);
+	if (curr->wait_heap != NULL)
+		thread_block();
+	intr_set_level(old_level);
 	lock_acquire(lock);
 }
 
-bool cmp_condition(struct list_elem *a, struct list_elem *b, void *aux UNUSED)
-{
-	struct semaphore_elem *sa = list_entry(a, struct semaphore_elem, elem);
-	struct semaphore_elem *sb = list_entry(b, struct semaphore_elem, elem);
-
-	struct list *list_a = &(sa->semaphore.waiters);
-	struct list *list_b = &(sb->semaphore.waiters);
-
-	struct thread *a_thread = list_entry(list_begin(list_a), struct thread, elem);
-	struct thread *b_thread = list_entry(list_begin(list_b), struct thread, elem);
-
-	int priority_a = a_thread->priority;
-	int priority_b = b_thread->priority;
-
-	return priority_a > priority_b;
-}
-
 /* If any threads are waiting on COND (protected by LOCK), then
    this function signals one of them to wake up from its wait.
    LOCK must be held before calling this function.
@@ -408,21 +893,23 @@ bool cmp_condition(struct list_elem *a, struct list_elem *b, void *aux UNUSED)
    interrupt handler. */
 void cond_signal(struct condition *cond, struct lock *lock UNUSED)
 {
+	enum intr_level old_level;
+
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 	ASSERT(!intr_context());
 	ASSERT(lock_held_by_current_thread(lock));
 
-	/**
-	 * NOTE: waiters 정렬
-	 * part: priority-sync
-	 */
-	list_sort(&cond->waiters, cmp_priority_donation, NULL);
-	if (!list_empty(&cond->waiters))
-		list_sort(&cond->waiters, cmp_condition, 0);
-	sema_up(&list_entry(list_pop_front(&cond->waiters),
-						struct semaphore_elem, elem)
-				 ->semaphore);
+	/* NOTE: [Improve] 대기자 heap의 루트가 가장 높은 우선순위의 대기자 */
+	old_level = intr_disable();
+	if (cond->waiters != NULL)
+	{
+		struct thread *t = waiter_heap_pop(&cond->waiters);
+		if (t->status == THREAD_BLOCKED)
+			thread_unblock(t);
+		thread_compare_yield();
+	}
+	intr_set_level(old_level);
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -436,23 +923,194 @@ void cond_broadcast(struct condition *cond, struct lock *lock)
 	ASSERT(cond != NULL);
 	ASSERT(lock != NULL);
 
-	while (!list_empty(&cond->waiters))
+	while (cond->waiters != NULL)
 		cond_signal(cond, lock);
 }
 
+/* NOTE: [Improve] Lock contention statistics (lockstat). */
+
+/* 집계할 수 있는 lock_class 수 */
+#define LOCKSTAT_MAX 128
+
+/* 이름 포인터로 lock_class를 찾는 해시 테이블의 크기 (2의 거듭제곱) */
+#define LOCKSTAT_HASH_SIZE 256
+
+bool lockstat_enabled;
+
+static struct lock_class lock_classes[LOCKSTAT_MAX];
+static size_t lock_class_cnt;
+
+/* 보고서의 type 열에 출력할 이름 (enum lock_class_type 순서) */
+static const char *lock_class_type_names[] = {"sema", "lock", "spin"};
+
+/* NOTE: [Improve] 이름 문자열의 주소 -> lock_class (open addressing)
+   이름은 lock_init()/sema_init()이 넘기는 문자열 리터럴이므로 주소만 비교하면 된다.
+   같은 내용의 리터럴이 다른 주소에 있으면 처음 볼 때만 strcmp로 찾아 별칭으로 등록한다. */
+struct lockstat_slot
+{
+	const char *name;		   /* 이름 문자열 주소 (빈 칸이면 NULL) */
+	enum lock_class_type type; /* 종류 */
+	struct lock_class *class;  /* 가리키는 lock_class */
+};
+static struct lockstat_slot lockstat_slots[LOCKSTAT_HASH_SIZE];
+
+/**
+ * @brief *CLASS가 아직 비어 있으면 NAME의 lock_class를 찾아 채우는 함수
+ * lock/semaphore/spinlock을 획득할 때마다 불리므로, lockstat이 꺼져 있으면 아무것도 하지 않는다.
+ * 인터럽트가 비활성화된 상태에서 호출되어야 한다.
+ *
+ * @param class lock/semaphore/spinlock의 class 멤버
+ * @param name lock/semaphore/spinlock 이름 (NULL이면 집계하지 않음)
+ * @param type lock/semaphore/spinlock 종류
+ * @return struct lock_class* 집계할 lock_class, 없으면 NULL
+ */
+static inline struct lock_class *lockstat_class(struct lock_class **class, const char *name, enum lock_class_type type)
+{
+	if (!lockstat_enabled)
+		return NULL;
+	if (*class == NULL && name != NULL)
+		*class = lockstat_lookup(name, type);
+	return *class;
+}
+
 /**
- * @brief 두 쓰레드의 우선순위를 비교하는 함수
+ * @brief 이름이 NAME인 lock_class를 찾고, 없으면 새로 등록하는 함수
+ * lock/semaphore/spinlock마다 한 번, lockstat이 켜진 뒤 처음 획득할 때만 불린다.
+ * 인터럽트가 비활성화된 상태에서 호출되어야 한다.
  *
- * @param a_ 첫 번째 리스트 요소
- * @param b_ 두 번째 리스트 요소
- * @param UNUSED 사용하지 않는 매개변수
- * @return true 첫 번째 쓰레드의 우선순위가 두 번째 쓰레드보다 높은 경우 true 반환
- * @return false 그렇지 않은 경우 false 반환
+ * @param name lock/semaphore/spinlock 이름
+ * @param type lock/semaphore/spinlock 종류
+ * @return struct lock_class* 찾거나 등록한 lock_class, 자리가 없으면 NULL
  */
-static bool cmp_priority_donation(const struct list_elem *a_, const struct list_elem *b_, void *aux UNUSED)
+static struct lock_class *lockstat_lookup(const char *name, enum lock_class_type type)
 {
-	struct thread *a = list_entry(a_, struct thread, d_elem);
-	struct thread *b = list_entry(b_, struct thread, d_elem);
+	struct lockstat_slot *slot;
+	struct lock_class *class = NULL;
+	size_t h, i;
+
+	ASSERT(intr_get_level() == INTR_OFF);
 
-	return a->priority > b->priority;
+	/* 주소로 찾기 */
+	h = (hash_bytes(&name, sizeof name) ^ type) & (LOCKSTAT_HASH_SIZE - 1);
+	for (i = 0; i < LOCKSTAT_HASH_SIZE; i++)
+	{
+		slot = &lockstat_slots[(h + i) & (LOCKSTAT_HASH_SIZE - 1)];
+		if (slot->name == NULL)
+			break;
+		if (slot->name == name && slot->type == type)
+			return slot->class;
+	}
+	if (i == LOCKSTAT_HASH_SIZE)
+		return NULL;
+
+	/* 처음 보는 주소: 같은 이름의 class가 있으면 별칭으로, 없으면 새로 등록 */
+	for (i = 0; i < lock_class_cnt; i++)
+	{
+		struct lock_class *c = &lock_classes[i];
+		if (c->type == type && !strcmp(c->name, name))
+		{
+			class = c;
+			break;
+		}
+	}
+	if (class == NULL && lock_class_cnt < LOCKSTAT_MAX)
+	{
+		class = &lock_classes[lock_class_cnt++];
+		class->name = name;
+		class->type = type;
+	}
+	if (class != NULL)
+	{
+		slot->name = name;
+		slot->type = type;
+		slot->class = class;
+	}
+	return class;
+}
+
+/**
+ * @brief 획득 한 번을 CLASS에 집계하는 함수
+ * 인터럽트가 비활성화된 상태에서 호출되어야 한다.
+ *
+ * @param class 집계할 lock_class (NULL이면 무시)
+ * @param contended 기다려야 했는지 여부
+ * @param start 기다리기 시작한 시각 (TSC)
+ */
+static void lockstat_wait(struct lock_class *class, bool contended, uint64_t start)
+{
+	if (!lockstat_enabled || class == NULL)
+		return;
+
+	class->acquired++;
+	if (contended && start != 0)
+	{
+		uint64_t waited = rdtsc() - start;
+		class->contended++;
+		class->wait_total += waited;
+		if (waited > class->wait_max)
+			class->wait_max = waited;
+	}
+}
+
+/**
+ * @brief 보유 시간 한 번을 CLASS에 집계하는 함수 (lock/spinlock을 놓을 때 호출)
+ * 인터럽트가 비활성화된 상태에서 호출되어야 한다.
+ *
+ * @param class 집계할 lock_class (NULL이면 무시)
+ * @param acquire_tsc 획득한 시각 (0이면 무시), 집계 후 0으로 되돌린다
+ */
+static void lockstat_hold(struct lock_class *class, uint64_t *acquire_tsc)
+{
+	if (lockstat_enabled && class != NULL && *acquire_tsc != 0)
+	{
+		uint64_t held = rdtsc() - *acquire_tsc;
+		class->hold_total += held;
+		if (held > class->hold_max)
+			class->hold_max = held;
+	}
+	*acquire_tsc = 0;
+}
+
+/* NOTE: [Improve] 경합 횟수, 대기 시간 순으로 정렬 (내림차순) */
+static bool lockstat_before(const struct lock_class *a, const struct lock_class *b)
+{
+	if (a->contended != b->contended)
+		return a->contended > b->contended;
+	return a->wait_total > b->wait_total;
+}
+
+/* Prints lock contention statistics, most contended first. */
+void lockstat_print_stats(void)
+{
+	struct lock_class *sorted[LOCKSTAT_MAX];
+	size_t cnt = 0;
+	size_t i, j;
+
+	if (!lockstat_enabled)
+		return;
+
+	for (i = 0; i < lock_class_cnt; i++)
+	{
+		struct lock_class *c = &lock_classes[i];
+		if (c->acquired == 0)
+			continue;
+
+		/* 삽입 정렬 */
+		for (j = cnt; j > 0 && lockstat_before(c, sorted[j - 1]); j--)
+			sorted[j] = sorted[j - 1];
+		sorted[j] = c;
+		cnt++;
+	}
+
+	printf("Lockstat: %zu of %zu lock classes used (times in cycles)\n", cnt, lock_class_cnt);
+	printf("  %-24s %4s %10s %10s %12s %12s %12s %12s\n",
+		   "name", "type", "acquired", "contended", "wait-total", "wait-max",
+		   "hold-total", "hold-max");
+	for (i = 0; i < cnt; i++)
+	{
+		struct lock_class *c = sorted[i];
+		printf("  %-24s %4s %10llu %10llu %12llu %12llu %12llu %12llu\n",
+			   c->name, lock_class_type_names[c->type], c->acquired, c->contended,
+			   c->wait_total, c->wait_max, c->hold_total, c->hold_max);
+	}
 }
@@ -13,6 +13,11 @@
 #include "intrinsic.h"
 #include "threads/fixed_point.h"
 #include "threads/malloc.h"
+#include "devices/timer.h"
+#include "threads/schedtrace.h"
+#include "threads/slab.h"
+#include "threads/switch.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #endif
@@ -26,12 +31,80 @@
    Do not modify this value. */
 #define THREAD_BASIC 0xd42df210
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
-
-/* NOTE: [1.1] 상태가 THREAD_BLOCKED인 쓰레드들의 리스트 */
-static struct list sleep_list;
+/* NOTE: [Improve] struct thread가 커지면 같은 페이지의 커널 스택이 그만큼 줄어든다.
+   크고 드물게 쓰는 멤버는 struct thread_ext에 넣고, 여기서 크기 상한을 검사한다. */
+#define THREAD_SIZE_MAX 768
+_Static_assert(sizeof(struct thread) <= THREAD_SIZE_MAX,
+			   "struct thread is too large; move cold members to struct thread_ext");
+
+/* NOTE: [Improve] run queue
+   THREAD_READY 상태의 쓰레드들을 우선순위(PRI_MIN ~ PRI_MAX)마다 FIFO로 관리한다.
+   bitmap의 i번째 비트는 queues[i]가 비어있지 않음을 나타내므로
+   가장 높은 우선순위의 쓰레드를 O(1)에 찾을 수 있다.
+   EDF 클래스의 쓰레드는 별도의 edf_queue에 절대 deadline 순으로 두며, 항상 우선순위 큐보다 먼저 실행한다.
+   CFS 정책(-cfs)에서는 우선순위 큐 대신 vruntime 순의 red-black tree(cfs_tree)를 쓴다.
+   인터럽트 비활성화로 보호한다. */
+#if PRI_MAX - PRI_MIN + 1 > 64
+#error run queue bitmap requires at most 64 priority levels
+#endif
+struct runqueue
+{
+	struct list queues[PRI_MAX + 1]; /* 우선순위별 FIFO */
+	struct list edf_queue;			 /* EDF 쓰레드 (deadline이 이른 순) */
+	struct rb_tree cfs_tree;		 /* CFS 정책의 쓰레드 (vruntime이 작은 순) */
+	uint64_t cfs_load;				 /* cfs_tree에 있는 쓰레드들의 weight 합 */
+	uint64_t min_vruntime;			 /* 단조 증가하는 vruntime 기준값 */
+	uint64_t bitmap;				 /* 비어있지 않은 queue의 비트맵 */
+	size_t cnt;						 /* run queue에 있는 쓰레드의 수 */
+	size_t queue_cnt[PRI_MAX + 1];	 /* 우선순위별 FIFO에 있는 쓰레드의 수 */
+	uint64_t remove_seq;			 /* 우선순위별 FIFO에서 쓰레드를 뺀 횟수 (mlfqs_ready_update()의 cursor 검사용) */
+};
+static struct runqueue ready_rq;
+
+/* NOTE: [1.1/Improve] 잠든 쓰레드들을 wakeup_tick 기준으로 관리하는 min-heap
+   struct thread에 내장된 sleep_child/sleep_sibling 포인터로 구성한 pairing heap이며,
+   루트가 가장 먼저 깨어나야 하는 쓰레드이다.
+   삽입은 O(1), 최소값 제거는 amortized O(log n). */
+static struct thread *sleep_heap;
+
+/* NOTE: [Improve] EDF(Earliest Deadline First) 실시간 스케줄링 클래스
+   쓰레드는 (runtime, period, deadline)을 선언하고, 매 period마다 deadline 안에 runtime 만큼의 CPU를 보장받는다.
+   admission control: 모든 EDF 쓰레드의 runtime / deadline 합이 EDF_UTIL_MAX를 넘지 않아야 한다.
+   이번 주기의 runtime을 다 쓴 쓰레드는 다음 주기까지 edf_throttled_list에서 잠든다. */
+#define EDF_UTIL_SCALE 1000000					  /* 이용률 단위 (1 = 100%) */
+#define EDF_UTIL_MAX (EDF_UTIL_SCALE / 100 * 95) /* 일반 클래스를 위해 5%는 남겨둠 */
+static int64_t edf_util;						  /* 승인된 EDF 쓰레드들의 이용률 합 */
+static struct list edf_throttled_list;			  /* runtime을 다 쓴 EDF 쓰레드 (다음 주기가 이른 순) */
+static long long edf_throttle_cnt, edf_miss_cnt;
+
+/* NOTE: [Improve] CFS(Completely Fair Scheduler) 정책
+   쓰레드는 nice에서 정해지는 weight에 반비례하는 속도로 vruntime이 증가하며,
+   항상 vruntime이 가장 작은 쓰레드를 실행하여 weight에 비례하게 CPU를 나눈다.
+   vruntime은 nice 0인 쓰레드가 1 tick 실행했을 때 CFS_TICK 만큼 증가한다. */
+#define CFS_TICK (1ULL << 20)
+#define CFS_NICE_0_WEIGHT 1024
+#define CFS_LATENCY 8		   /* 실행 가능한 쓰레드가 모두 한 번씩 실행되는 목표 주기 (tick) */
+#define CFS_MIN_GRANULARITY 1 /* 선점되기 전 최소 실행 시간 (tick) */
+#define CFS_WAKEUP_GRANULARITY CFS_TICK /* 이 이상 vruntime이 작은 쓰레드가 깨어나야 선점 */
+#define CFS_SLEEPER_CREDIT (CFS_LATENCY * CFS_TICK / 2) /* 잠들었다 깨어난 쓰레드가 받을 수 있는 최대 이득 */
+
+/* nice -20 ~ 20 에 해당하는 weight. nice가 1 차이 나면 CPU 비율이 약 1.25배 차이 난다. */
+static const uint32_t cfs_nice_weight[] = {
+	/* -20 */ 88761, 71755, 56483, 46273, 36291,
+	/* -15 */ 29154, 23254, 18705, 14949, 11916,
+	/* -10 */ 9548, 7620, 6100, 4904, 3906,
+	/*  -5 */ 3121, 2501, 1991, 1586, 1277,
+	/*   0 */ 1024, 820, 655, 526, 423,
+	/*   5 */ 335, 272, 215, 172, 137,
+	/*  10 */ 110, 87, 70, 56, 45,
+	/*  15 */ 36, 29, 23, 18, 15,
+	/*  20 */ 12,
+};
+
+/* If false (default), use the scheduler selected by thread_mlfqs.
+   If true, use the weighted fair-share (CFS) scheduler.
+   Controlled by kernel command-line option "-cfs". */
+bool thread_cfs;
 
 /* NOTE: [Improve] 모든 쓰레드를 담는 리스트 */
 static struct list all_list;
@@ -45,12 +118,28 @@ static struct thread *idle_thread;
 /* Initial thread, the thread running init.c:main(). */
 static struct thread *initial_thread;
 
+/* NOTE: [Improve] struct thread_ext 할당용 slab cache
+   initial thread는 slab이 초기화되기 전부터 돌고 있으므로 정적 변수를 쓴다. */
+static struct slab_cache thread_ext_cache;
+static struct thread_ext initial_thread_ext;
+
 /* Lock used by allocate_tid(). */
 static struct lock tid_lock;
 
 /* Thread destruction requests */
 static struct list destruction_req;
 
+/* NOTE: [Improve] 죽은 쓰레드의 페이지와 FDT 페이지를 해제하지 않고 재사용하기 위한 캐시
+   thread_create()/fork가 매번 palloc과 페이지 zeroing을 거치지 않도록 한다.
+   do_schedule()에서 인터럽트가 꺼진 채로 접근하므로 인터럽트 비활성화로 보호한다. */
+#define THREAD_CACHE_MAX 32
+static struct list thread_cache; /* 재사용할 쓰레드 페이지 (struct thread의 elem으로 연결) */
+static size_t thread_cache_cnt;
+static struct list fdt_cache; /* 재사용할 FDT 페이지 (페이지 맨 앞의 list_elem으로 연결) */
+static size_t fdt_cache_cnt;
+static long long thread_cache_hits, thread_cache_misses;
+static long long fdt_cache_hits, fdt_cache_misses;
+
 /* Statistics. */
 static long long idle_ticks;   /* # of timer ticks spent idle. */
 static long long kernel_ticks; /* # of timer ticks in kernel threads. */
@@ -60,9 +149,27 @@ static long long user_ticks;   /* # of timer ticks in user programs. */
 #define TIME_SLICE 4		  /* # of timer ticks to give each thread. */
 static unsigned thread_ticks; /* # of timer ticks since last yield. */
 
+/* NOTE: [Improve] 우선순위 구간별 기본 time slice (tick)
+   높은 우선순위(대화형)는 짧게 잡아 디스패치 지연을 줄이고, 낮은 우선순위
+   (MLFQS에서는 recent_cpu가 큰 CPU 위주 쓰레드)는 길게 잡아 문맥 전환을 줄인다.
+   PRI_DEFAULT가 속한 구간은 기존 TIME_SLICE를 그대로 쓴다. */
+#define SLICE_BANDS 8
+#define SLICE_BAND_WIDTH ((PRI_MAX - PRI_MIN + 1) / SLICE_BANDS)
+static const unsigned slice_table[SLICE_BANDS] = {12, 10, 8, TIME_SLICE, TIME_SLICE, 3, 2, 2};
+#define SLICE_SHIFT_MAX 2 /* slice를 끝까지 쓰는 쓰레드는 기본값의 최대 4배까지 늘린다 */
+static long long slice_expired_cnt;	   /* slice를 모두 써서 선점된 횟수 */
+static long long slice_surrendered_cnt; /* slice가 남은 채 스스로 block된 횟수 */
+
 /* NOTE: [1.3] 시스템 부하 */
 fixed_point load_avg;
 
+/* NOTE: [Improve] recent_cpu의 지연(lazy) decay를 위한 초 단위 기록
+   매 초 적용된 decay 계수를 DECAY_HISTORY 초 동안 보관하여,
+   BLOCKED 상태였던 쓰레드가 깨어날 때 놓친 decay를 한꺼번에 적용한다. */
+#define DECAY_HISTORY 64
+static fixed_point decay_history[DECAY_HISTORY];
+static int64_t mlfqs_seconds; /* 지금까지 recent_cpu decay가 일어난 횟수 (초) */
+
 /* If false (default), use round-robin scheduler.
    If true, use multi-level feedback queue scheduler.
    Controlled by kernel command-line option "-o mlfqs". */
@@ -73,13 +180,39 @@ static void kernel_thread(thread_func *, void *aux);
 static void idle(void *aux UNUSED);
 static struct thread *next_thread_to_run(void);
 static void init_thread(struct thread *, const char *name, int priority);
+static struct thread *thread_page_alloc(void);
+static void thread_page_free(struct thread *t);
 static void do_schedule(int status);
 static void schedule(void);
 static tid_t allocate_tid(void);
 
-static int64_t get_min_tick(void);
-static int set_global_tick(int64_t tick);
-static bool wakeup_less(const struct list_elem *a_, const struct list_elem *b_, void *aux UNUSED);
+static unsigned thread_slice(const struct thread *t);
+static void ready_queue_push(struct runqueue *rq, struct thread *t);
+static void ready_queue_remove(struct runqueue *rq, struct thread *t);
+static int ready_queue_max_priority(struct runqueue *rq);
+static struct thread *ready_queue_pop(struct runqueue *rq);
+static bool ready_queue_preempts(struct runqueue *rq, struct thread *curr);
+
+static uint64_t cfs_weight(struct thread *t);
+static void cfs_place(struct runqueue *rq, struct thread *t);
+static bool cfs_tick(struct thread *curr);
+static bool cfs_less(const struct rb_node *a_, const struct rb_node *b_, void *aux UNUSED);
+
+static void edf_new_period(struct thread *t, int64_t start);
+static void edf_tick(struct thread *curr, int64_t now);
+static bool edf_deadline_less(const struct list_elem *a_, const struct list_elem *b_, void *aux UNUSED);
+static bool edf_period_less(const struct list_elem *a_, const struct list_elem *b_, void *aux UNUSED);
+
+static int mlfqs_priority(struct thread *t);
+static void mlfqs_ready_update(void *aux);
+
+/* NOTE: [Improve] READY 쓰레드의 recent_cpu/priority 갱신을 worker에게 넘기기 위한 work */
+static struct work mlfqs_work;
+#define MLFQS_UPDATE_BATCH 8 /* mlfqs_ready_update()가 인터럽트를 끈 채로 갱신하는 최대 쓰레드 수 */
+static fixed_point pow_fp(fixed_point x, int64_t n);
+
+static struct thread *sleep_heap_meld(struct thread *a, struct thread *b);
+static struct thread *sleep_heap_pop(void);
 
 /* Returns true if T appears to point to a valid thread. */
 #define is_thread(t) ((t) != NULL && (t)->magic == THREAD_MAGIC)
@@ -125,10 +258,24 @@ void thread_init(void)
 
 	/* Init the globla thread context */
 	lock_init(&tid_lock);
-	list_init(&ready_list);
-	list_init(&sleep_list); /* sleep list 초기화 */
+	for (int i = PRI_MIN; i <= PRI_MAX; i++)
+	{
+		list_init(&ready_rq.queues[i]);
+		ready_rq.queue_cnt[i] = 0;
+	}
+	list_init(&ready_rq.edf_queue);
+	rb_init(&ready_rq.cfs_tree);
+	ready_rq.cfs_load = 0;
+	ready_rq.min_vruntime = 0;
+	ready_rq.bitmap = 0;
+	ready_rq.cnt = 0;
+	ready_rq.remove_seq = 0;
+	sleep_heap = NULL;		/* sleep heap 초기화 */
 	list_init(&all_list);	/* NOTE: [Improve] all list 초기화 */
 	list_init(&destruction_req);
+	list_init(&thread_cache);
+	list_init(&fdt_cache);
+	list_init(&edf_throttled_list);
 
 	global_tick = INT64_MAX; /* global tick 초기화 */
 	load_avg = int_to_fp(0); /* NOTE: [1.3] load_avg 초기화 */
@@ -138,12 +285,16 @@ void thread_init(void)
 	init_thread(initial_thread, "main", PRI_DEFAULT);
 	initial_thread->status = THREAD_RUNNING;
 	initial_thread->tid = allocate_tid();
+	initial_thread->ext = &initial_thread_ext;
 }
 
 /* Starts preemptive thread scheduling by enabling interrupts.
    Also creates the idle thread. */
 void thread_start(void)
 {
+	/* NOTE: [Improve] thread_create()가 쓰는 slab cache (slab_init() 이후라 여기서 초기화) */
+	slab_cache_init(&thread_ext_cache, "thread_ext", sizeof(struct thread_ext), NULL);
+
 	/* Create the idle thread. */
 	struct semaphore idle_started;
 	sema_init(&idle_started, 0);
@@ -158,23 +309,48 @@ void thread_start(void)
 
 /* Called by the timer interrupt handler at each timer tick.
    Thus, this function runs in an external interrupt context. */
-void thread_tick(void)
+void thread_tick(bool user)
 {
 	struct thread *t = thread_current();
 
-	/* Update statistics. */
+	/* Update statistics.
+	   NOTE: [Improve] 프로세스 쓰레드라도 시스템 콜 처리 중이었다면 kernel tick으로 센다. */
 	if (t == idle_thread)
 		idle_ticks++;
-#ifdef USERPROG
-	else if (t->pml4 != NULL)
+	else if (user)
 		user_ticks++;
-#endif
 	else
 		kernel_ticks++;
 
-	/* Enforce preemption. */
-	if (++thread_ticks >= TIME_SLICE)
-		intr_yield_on_return();
+	if (user)
+		t->ext->ru.ru_utime++;
+	else
+		t->ext->ru.ru_stime++;
+
+	/* NOTE: [Improve] EDF 주기 갱신과 runtime 소진 처리 */
+	edf_tick(t, timer_ticks());
+
+	/* Enforce preemption.
+	   NOTE: [Improve] idle 쓰레드는 ready queue가 비어있을 때만 실행되므로 선점할 필요가 없음
+	   (tickless 모드에서 인터럽트 밖에서 tick을 보정할 때도 호출됨)
+	   CFS 정책에서는 고정된 time slice 대신 cfs_tick()이 선점 여부를 정한다. */
+	if (t != idle_thread)
+	{
+		++thread_ticks;
+		if (thread_cfs && !t->edf)
+		{
+			if (cfs_tick(t))
+				intr_yield_on_return();
+		}
+		else if (thread_ticks >= thread_slice(t))
+		{
+			/* NOTE: [Improve] slice를 다 쓴 쓰레드는 CPU 위주로 보고 다음 slice를 늘린다 */
+			slice_expired_cnt++;
+			if (t->slice_shift < SLICE_SHIFT_MAX)
+				t->slice_shift++;
+			intr_yield_on_return();
+		}
+	}
 }
 
 /* Prints thread statistics. */
@@ -182,6 +358,10 @@ void thread_print_stats(void)
 {
 	printf("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
 		   idle_ticks, kernel_ticks, user_ticks);
+	printf("Thread cache: %lld hits, %lld misses; FDT cache: %lld hits, %lld misses\n",
+		   thread_cache_hits, thread_cache_misses, fdt_cache_hits, fdt_cache_misses);
+	printf("EDF: %lld throttles, %lld deadline misses\n", edf_throttle_cnt, edf_miss_cnt);
+	printf("Time slice: %lld expired, %lld surrendered\n", slice_expired_cnt, slice_surrendered_cnt);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -208,24 +388,46 @@ tid_t thread_create(const char *name, int priority,
 	ASSERT(function != NULL);
 
 	/* Allocate thread. */
-	t = palloc_get_page(PAL_ZERO);
+	t = thread_page_alloc();
 	if (t == NULL)
 		return TID_ERROR;
 
+	/* NOTE: [2.4/Improve] 파일 디스크립터 테이블에 메모리 할당
+	   init_thread()가 all_list에 넣기 전에 할당해야 실패 시 안전하게 되돌릴 수 있음 */
+	struct file **fdt = thread_fdt_alloc();
+	if (fdt == NULL)
+	{
+		thread_page_free(t);
+		return TID_ERROR;
+	}
+
+	/* NOTE: [Improve] 스레드 페이지 밖에 둘 데이터 할당 */
+	struct thread_ext *ext = slab_alloc(&thread_ext_cache);
+	if (ext == NULL)
+	{
+		thread_fdt_free(fdt);
+		thread_page_free(t);
+		return TID_ERROR;
+	}
+
 	/* Initialize thread. */
 	init_thread(t, name, priority);
 	tid = t->tid = allocate_tid();
+	memset(ext, 0, sizeof *ext);
+	t->ext = ext;
 
 	/* Call the kernel_thread if it scheduled.
-	 * Note) rdi is 1st argument, and rsi is 2nd argument. */
-	t->tf.rip = (uintptr_t)kernel_thread;
-	t->tf.R.rdi = (uint64_t)function;
-	t->tf.R.rsi = (uint64_t)aux;
-	t->tf.ds = SEL_KDSEG;
-	t->tf.es = SEL_KDSEG;
-	t->tf.ss = SEL_KDSEG;
-	t->tf.cs = SEL_KCSEG;
-	t->tf.eflags = FLAG_IF;
+	 * NOTE: [Improve] 첫 thread_switch()가 thread_switch_entry로 돌아가서
+	 * kernel_thread(function, aux)를 호출하도록 스택 맨 위에 switch_frame을 만든다.
+	 * thread_switch_entry에서 rsp가 16 byte 정렬되도록 8 byte 여유를 둔다. */
+	struct switch_frame *sf =
+		(struct switch_frame *)((uint8_t *)t + PGSIZE - 2 * sizeof(uint64_t)) - 1;
+	memset(sf, 0, sizeof *sf);
+	sf->rbx = (uint64_t)kernel_thread;
+	sf->r12 = (uint64_t)function;
+	sf->r13 = (uint64_t)aux;
+	sf->rip = thread_switch_entry;
+	t->ctx_rsp = (uint64_t)sf;
 
 	/* NOTE: [2.3] 자료구조 초기화 */
 	/* 부모 프로세스 저장 */
@@ -240,13 +442,7 @@ tid_t thread_create(const char *name, int priority,
 	list_push_back(&thread_current()->child_list, &t->c_elem);
 
 	/* NOTE: [2.4] 파일 디스크립터 초기화 */
-	/* File Descriptor 테이블에 메모리 할당 */
-	t->fdt = palloc_get_page(PAL_ZERO);
-	if (t->fdt == NULL)
-	{
-		palloc_free_page(t);
-		return TID_ERROR;
-	}
+	t->fdt = fdt;
 
 	/* Add to run queue. */
 	thread_unblock(t);
@@ -270,6 +466,7 @@ void thread_block(void)
 {
 	ASSERT(!intr_context());
 	ASSERT(intr_get_level() == INTR_OFF);
+	sched_trace_event(SCHED_BLOCK, thread_current()->tid, thread_current()->priority, 0);
 	thread_current()->status = THREAD_BLOCKED;
 	schedule();
 }
@@ -291,11 +488,32 @@ void thread_unblock(struct thread *t)
 	old_level = intr_disable();
 	ASSERT(t->status == THREAD_BLOCKED);
 
+	/* NOTE: [Improve] BLOCKED 동안 놓친 recent_cpu decay를 반영한 뒤 우선순위 재계산 */
+	if (thread_mlfqs && t != idle_thread)
+	{
+		thread_calc_recent_cpu(t);
+		t->priority = mlfqs_priority(t);
+	}
+
+	/* NOTE: [Improve] CFS 정책에서는 깨어난 쓰레드의 vruntime을 run queue 기준으로 맞춤 */
+	if (thread_cfs)
+		cfs_place(&ready_rq, t);
+
+	/* NOTE: [Improve] 주기가 지난 뒤에 깨어난 EDF 쓰레드는 지금부터 새 주기를 시작 */
+	if (t->edf && !t->edf_throttled)
+	{
+		int64_t now = timer_ticks();
+		if (now >= t->edf_next_period)
+			edf_new_period(t, now);
+	}
+
 	/**
-	 * NOTE: ready_list에 우선순위 순으로 삽입
+	 * NOTE: 해당 우선순위의 ready queue 끝에 삽입
 	 * part: priority-insert-ordered
 	 */
-	list_insert_ordered(&ready_list, &t->elem, compare_priority, NULL);
+	sched_trace_event(SCHED_UNBLOCK, t->tid, t->priority, 0);
+	sched_trace_ready(t, true);
+	ready_queue_push(&ready_rq, t);
 	t->status = THREAD_READY;
 	intr_set_level(old_level);
 }
@@ -340,10 +558,17 @@ void thread_exit(void)
 
 #ifdef USERPROG
 	process_exit();
+#else
+	thread_fdt_free(thread_current()->fdt);
 #endif
+	/* NOTE: [Improve] magazine에 남은 블록을 malloc의 free list로 돌려줌 */
+	malloc_drain();
+
 	/* Just set our status to dying and schedule another process.
 	   We will be destroyed during the call to schedule_tail(). */
 	intr_disable();
+	if (thread_current()->edf)
+		edf_util -= thread_current()->edf_util;
 	do_schedule(THREAD_DYING);
 	NOT_REACHED();
 }
@@ -355,12 +580,7 @@ void thread_compare_yield(void)
 		return;
 	}
 
-	if (list_empty(&ready_list))
-	{
-		return;
-	}
-
-	if (thread_current()->priority < list_entry(list_begin(&ready_list), struct thread, elem)->priority)
+	if (ready_queue_preempts(&ready_rq, thread_current()))
 		thread_yield();
 }
 
@@ -381,12 +601,24 @@ void thread_yield(void)
 	old_level = intr_disable();
 
 	/**
-	 * NOTE: ready_list에 우선순위 순으로 삽입
+	 * NOTE: 해당 우선순위의 ready queue 끝에 삽입
 	 * part: priority-insert-ordered
 	 */
-	if (curr != idle_thread)
-		list_insert_ordered(&ready_list, &curr->elem, compare_priority, NULL);
-	do_schedule(THREAD_READY);
+	if (curr->edf_throttled)
+	{
+		/* NOTE: [Improve] runtime을 다 쓴 EDF 쓰레드는 다음 주기까지 run queue에 넣지 않음 */
+		list_insert_ordered(&edf_throttled_list, &curr->elem, edf_period_less, NULL);
+		do_schedule(THREAD_BLOCKED);
+	}
+	else
+	{
+		if (curr != idle_thread)
+		{
+			sched_trace_ready(curr, false);
+			ready_queue_push(&ready_rq, curr);
+		}
+		do_schedule(THREAD_READY);
+	}
 	intr_set_level(old_level);
 }
 
@@ -407,9 +639,10 @@ void thread_sleep(int64_t wakeup_tick)
 	if (curr != idle_thread)
 	{
 		curr->wakeup_tick = wakeup_tick; /* local tick 설정 */
-		if (wakeup_tick < global_tick)	 /* 필요시 global_tick 갱신 */
-			set_global_tick(wakeup_tick);
-		list_push_back(&sleep_list, &curr->elem); /* sleep_list에 쓰레드 삽입 */
+		curr->sleep_child = NULL;
+		curr->sleep_sibling = NULL;
+		sleep_heap = sleep_heap_meld(sleep_heap, curr); /* sleep heap에 쓰레드 삽입 */
+		global_tick = sleep_heap->wakeup_tick;			/* global_tick 갱신 */
 	}
 	do_schedule(THREAD_BLOCKED); /* 현재 쓰레드를 blocked 상태로 스케줄링 */
 	intr_set_level(old_level);	 /* 이전 인터럽트 복원 */
@@ -425,28 +658,87 @@ void thread_wakeup(int64_t curr_tick)
 	if (global_tick > curr_tick) /* 현재 tick이 global tick보다 작은 경우 함수 종료 */
 		return;
 
-	if (list_empty(&sleep_list)) /* sleep_list가 비어있는 경우 함수 종료 */
-		return;
+	/* heap의 루트부터 깨어날 시간이 지난 쓰레드들을 차례로 꺼내 block 해제 */
+	while (sleep_heap != NULL && sleep_heap->wakeup_tick <= curr_tick)
+	{
+		struct thread *t = sleep_heap_pop();
 
-	struct list_elem *e;
-	struct thread *t;
+		sched_trace_event(SCHED_WAKEUP, t->tid, t->priority, curr_tick);
+		thread_unblock(t);
+	}
 
-	e = list_begin(&sleep_list);
-	while (e != list_end(&sleep_list)) /* sleep_list를 순회하며 깨어날 쓰레드 처리 */
+	/* global_tick 갱신 */
+	global_tick = sleep_heap != NULL ? sleep_heap->wakeup_tick : INT64_MAX;
+}
+
+/* NOTE: [Improve] 가장 먼저 깨어나야 하는 쓰레드의 wakeup tick을 반환 (없으면 INT64_MAX)
+   다음 주기를 기다리는 EDF 쓰레드도 포함한다. */
+int64_t thread_next_wakeup(void)
+{
+	if (!list_empty(&edf_throttled_list))
 	{
-		t = list_entry(e, struct thread, elem); /* 해당 elem와 매핑된 thread */
+		struct thread *t = list_entry(list_front(&edf_throttled_list), struct thread, elem);
+		if (t->edf_next_period < global_tick)
+			return t->edf_next_period;
+	}
+	return global_tick;
+}
 
-		if (t->wakeup_tick <= curr_tick) /* wakeup 필요 */
-		{
-			e = list_remove(e); /* sleep_list에서 제거 */
-			thread_unblock(t);	/* 쓰레드 block 해제 후 */
-			// thread_compare_yield();
-			set_global_tick(get_min_tick()); /* global_tick 갱신 */
-		}
-		else
-			e = e->next;
+/**
+ * @brief 현재 쓰레드를 EDF 클래스로 옮기는 함수
+ * 매 PERIOD tick마다, 주기가 시작된 뒤 DEADLINE tick 안에 RUNTIME tick 만큼의 CPU를 보장받는다.
+ * 이미 EDF 클래스라면 새 값으로 바꾼다.
+ *
+ * @param runtime 주기마다 필요한 실행 시간 (tick)
+ * @param period 주기 (tick)
+ * @param deadline 주기 시작부터 deadline까지의 시간 (tick)
+ * @return true 승인된 경우
+ * @return false 값이 잘못되었거나 승인하면 EDF 이용률 합이 EDF_UTIL_MAX를 넘는 경우
+ */
+bool thread_set_edf(int64_t runtime, int64_t period, int64_t deadline)
+{
+	struct thread *curr = thread_current();
+	enum intr_level old_level;
+	int64_t util, others;
+
+	if (runtime <= 0 || runtime > deadline || deadline > period)
+		return false;
+	util = runtime * EDF_UTIL_SCALE / deadline;
+
+	old_level = intr_disable();
+	others = edf_util - (curr->edf ? curr->edf_util : 0);
+	if (others + util > EDF_UTIL_MAX)
+	{
+		intr_set_level(old_level);
+		return false;
 	}
-	set_global_tick(get_min_tick()); /* global_tick 갱신 */
+
+	edf_util = others + util;
+	curr->edf = true;
+	curr->edf_util = util;
+	curr->edf_runtime = runtime;
+	curr->edf_period = period;
+	curr->edf_rel_deadline = deadline;
+	edf_new_period(curr, timer_ticks());
+	thread_compare_yield();
+	intr_set_level(old_level);
+	return true;
+}
+
+/* NOTE: [Improve] 현재 쓰레드를 EDF 클래스에서 원래의 우선순위 스케줄링으로 되돌림 */
+void thread_clear_edf(void)
+{
+	struct thread *curr = thread_current();
+	enum intr_level old_level;
+
+	old_level = intr_disable();
+	if (curr->edf)
+	{
+		edf_util -= curr->edf_util;
+		curr->edf = false;
+		thread_compare_yield();
+	}
+	intr_set_level(old_level);
 }
 
 /* Sets the current thread's priority to NEW_PRIORITY. */
@@ -456,25 +748,15 @@ void thread_set_priority(int new_priority)
 	if (thread_mlfqs)
 		return;
 
-	/* NOTE: donation 고려하여 우선순위 설정 */
-	if (thread_current()->origin_priority == thread_current()->priority)
-		thread_current()
-			->priority = new_priority;
+	/* NOTE: donation 고려하여 우선순위 설정 (보유 중인 lock의 대기자 우선순위와 비교) */
 	thread_current()->origin_priority = new_priority;
 
 	/**
-	 * NOTE: Reorder the ready_list
+	 * NOTE: donation 반영 후 ready queue의 최고 우선순위와 비교
 	 * part: priority-insert-ordered
 	 */
-	// if(thread_current()->wait_on_lock != NULL){
-	// 	update_donate_priority(&thread_current()->wait_on_lock);
-	// }
 	update_donate_priority();
-	if (!list_empty(&ready_list))
-	{
-		struct thread *t = list_entry(list_front(&ready_list), struct thread, elem);
-		thread_compare_yield();
-	}
+	thread_compare_yield();
 }
 
 /* Returns the current thread's priority. */
@@ -491,7 +773,9 @@ void thread_set_nice(int new_nice)
 	enum intr_level old_level = intr_disable();
 	if (thread_current() != idle_thread)
 		thread_current()->nice = new_nice;
-	thread_calc_priority(thread_current());
+	/* NOTE: [Improve] CFS 정책에서는 nice가 weight로만 쓰이므로 우선순위는 그대로 둠 */
+	if (thread_mlfqs)
+		thread_calc_priority(thread_current());
 	thread_compare_yield();
 	intr_set_level(old_level);
 }
@@ -564,6 +848,9 @@ idle(void *idle_started_ UNUSED)
 		intr_disable();
 		thread_block();
 
+		/* NOTE: [Improve] tickless 모드라면 다음 wakeup 시점까지 타이머를 one-shot으로 설정 */
+		timer_idle_enter();
+
 		/* Re-enable interrupts and wait for the next one.
 
 		   The `sti' instruction disables interrupts until the
@@ -577,6 +864,9 @@ idle(void *idle_started_ UNUSED)
 		   See [IA32-v2a] "HLT", [IA32-v2b] "STI", and [IA32-v3a]
 		   7.11.1 "HLT Instruction". */
 		asm volatile("sti; hlt" : : : "memory");
+
+		/* 다른 인터럽트로 먼저 깨어났다면 경과한 tick만큼 보정 */
+		timer_idle_exit();
 	}
 }
 
@@ -603,17 +893,21 @@ init_thread(struct thread *t, const char *name, int priority)
 	memset(t, 0, sizeof *t);
 	t->status = THREAD_BLOCKED;
 	strlcpy(t->name, name, sizeof t->name);
-	t->tf.rsp = (uint64_t)t + PGSIZE - sizeof(void *);
 	t->priority = priority;
 	t->magic = THREAD_MAGIC;
 
 	/* NOTE: donation을 위한 데이터 초기화 */
-	list_init(&t->donations);
+	list_init(&t->held_locks);
 	t->origin_priority = priority;
 
 	/* NOTE: [1.3] MLFQ를 위한 데이터 초기화 */
 	t->nice = 0;
 	t->recent_cpu = 0;
+	t->recent_cpu_sec = mlfqs_seconds;
+	t->slice_shift = 0;
+
+	/* NOTE: [Improve] 새 쓰레드는 현재 run queue의 기준 vruntime에서 시작 */
+	t->vruntime = ready_rq.min_vruntime;
 
 	/* NOTE: [Improve] 모든 쓰레드 생성 시 all_list에 추가 */
 	list_push_back(&all_list, &t->all_elem);
@@ -621,6 +915,16 @@ init_thread(struct thread *t, const char *name, int priority)
 	/* NOTE: [2.3] 자식 리스트 초기화 */
 	list_init(&t->child_list);
 	t->run_file = NULL;
+
+#ifdef USERPROG
+	/* NOTE: [Improve] uthread_create()로 만들어지기 전까지는 스스로가 leader */
+	t->leader = t;
+	list_init(&t->group);
+	t->ustack_slot = -1;
+#endif
+#ifdef VM
+	lock_init(&t->vm_lock);
+#endif
 }
 
 /* Chooses and returns the next thread to be scheduled.  Should
@@ -631,13 +935,135 @@ init_thread(struct thread *t, const char *name, int priority)
 static struct thread *
 next_thread_to_run(void)
 {
-	if (list_empty(&ready_list))
-		return idle_thread;
+	struct thread *next = ready_queue_pop(&ready_rq);
+
+	return next != NULL ? next : idle_thread;
+}
+
+/* NOTE: [Improve] 쓰레드 T를 자신의 우선순위에 해당하는 ready queue 끝에 삽입
+   인터럽트가 비활성화된 상태에서 호출해야 한다. */
+static void ready_queue_push(struct runqueue *rq, struct thread *t)
+{
+	ASSERT(PRI_MIN <= t->priority && t->priority <= PRI_MAX);
+
+	if (t->edf)
+		list_insert_ordered(&rq->edf_queue, &t->elem, edf_deadline_less, NULL);
+	else if (thread_cfs)
+	{
+		rb_insert(&rq->cfs_tree, &t->cfs_node, cfs_less, NULL);
+		rq->cfs_load += cfs_weight(t);
+	}
 	else
-		return list_entry(list_pop_front(&ready_list), struct thread, elem);
+	{
+		list_push_back(&rq->queues[t->priority], &t->elem);
+		rq->bitmap |= 1ULL << t->priority;
+		rq->queue_cnt[t->priority]++;
+	}
+	rq->cnt++;
 }
 
-/* Use iretq to launch the thread */
+/* NOTE: [Improve] ready queue에서 쓰레드 T를 제거하고, 큐가 비면 비트를 내림
+   인터럽트가 비활성화된 상태에서 호출해야 한다. */
+static void ready_queue_remove(struct runqueue *rq, struct thread *t)
+{
+	if (t->edf)
+		list_remove(&t->elem);
+	else if (thread_cfs)
+	{
+		rb_remove(&rq->cfs_tree, &t->cfs_node);
+		rq->cfs_load -= cfs_weight(t);
+	}
+	else
+	{
+		list_remove(&t->elem);
+		if (list_empty(&rq->queues[t->priority]))
+			rq->bitmap &= ~(1ULL << t->priority);
+		rq->queue_cnt[t->priority]--;
+		rq->remove_seq++;
+	}
+	rq->cnt--;
+}
+
+/* NOTE: [Improve] ready queue 중 가장 높은 우선순위를 반환 (비어있으면 PRI_MIN - 1) */
+static int ready_queue_max_priority(struct runqueue *rq)
+{
+	uint64_t bitmap = rq->bitmap;
+
+	if (bitmap == 0)
+		return PRI_MIN - 1;
+	return 63 - __builtin_clzll(bitmap);
+}
+
+/* NOTE: [Improve] 다음에 실행할 쓰레드를 꺼내 반환 (비어있으면 NULL)
+   deadline이 가장 이른 EDF 쓰레드, 없으면 가장 높은 우선순위의 쓰레드
+   (CFS 정책에서는 vruntime이 가장 작은 쓰레드)를 꺼낸다.
+   인터럽트가 비활성화된 상태에서 호출해야 한다. */
+static struct thread *ready_queue_pop(struct runqueue *rq)
+{
+	struct thread *t;
+
+	if (!list_empty(&rq->edf_queue))
+		t = list_entry(list_front(&rq->edf_queue), struct thread, elem);
+	else if (thread_cfs && !rb_empty(&rq->cfs_tree))
+		t = rb_entry(rb_first(&rq->cfs_tree), struct thread, cfs_node);
+	else if (rq->bitmap != 0)
+		t = list_entry(list_front(&rq->queues[ready_queue_max_priority(rq)]), struct thread, elem);
+	else
+		return NULL;
+
+	ready_queue_remove(rq, t);
+	return t;
+}
+
+/* NOTE: [Improve] RQ에 CURR보다 먼저 실행되어야 할 쓰레드가 있으면 true
+   EDF 쓰레드는 일반 쓰레드보다 항상 먼저이고, EDF 쓰레드끼리는 deadline이 이른 쪽이 먼저이다. */
+static bool ready_queue_preempts(struct runqueue *rq, struct thread *curr)
+{
+	if (!list_empty(&rq->edf_queue))
+	{
+		struct thread *t = list_entry(list_front(&rq->edf_queue), struct thread, elem);
+		return !curr->edf || t->edf_deadline < curr->edf_deadline;
+	}
+	if (curr->edf)
+		return false;
+	if (thread_cfs)
+	{
+		struct rb_node *first = rb_first(&rq->cfs_tree);
+		return first != NULL && rb_entry(first, struct thread, cfs_node)->vruntime + CFS_WAKEUP_GRANULARITY < curr->vruntime;
+	}
+	return curr->priority < ready_queue_max_priority(rq);
+}
+
+/**
+ * @brief 쓰레드의 우선순위를 변경하는 함수
+ * READY 상태의 쓰레드라면 새 우선순위의 ready queue로 옮겨 정렬 상태를 유지하고,
+ * 대기자 heap에 들어가 있다면 (cond_wait()에서 잠들기 직전 등) heap에서도 자리를 다시 잡는다.
+ *
+ * @param t 우선순위를 변경할 쓰레드
+ * @param new_priority 새 우선순위
+ */
+void thread_change_priority(struct thread *t, int new_priority)
+{
+	enum intr_level old_level;
+
+	if (t->priority == new_priority)
+		return;
+
+	old_level = intr_disable();
+	if (t->status == THREAD_READY)
+	{
+		ready_queue_remove(&ready_rq, t);
+		t->priority = new_priority;
+		ready_queue_push(&ready_rq, t);
+	}
+	else
+		t->priority = new_priority;
+	waiter_heap_update(t);
+	intr_set_level(old_level);
+}
+
+/* Use iretq to launch the thread.
+   NOTE: [Improve] 사용자 모드로 들어갈 때만 사용. 커널 쓰레드끼리는 thread_switch()로 전환 */
 void do_iret(struct intr_frame *tf)
 {
 	__asm __volatile(
@@ -678,60 +1104,12 @@ void do_iret(struct intr_frame *tf)
 static void
 thread_launch(struct thread *th)
 {
-	uint64_t tf_cur = (uint64_t)&running_thread()->tf;
-	uint64_t tf = (uint64_t)&th->tf;
 	ASSERT(intr_get_level() == INTR_OFF);
 
-	/* The main switching logic.
-	 * We first restore the whole execution context into the intr_frame
-	 * and then switching to the next thread by calling do_iret.
-	 * Note that, we SHOULD NOT use any stack from here
-	 * until switching is done. */
-	__asm __volatile(
-		/* Store registers that will be used. */
-		"push %%rax\n"
-		"push %%rbx\n"
-		"push %%rcx\n"
-		/* Fetch input once */
-		"movq %0, %%rax\n"
-		"movq %1, %%rcx\n"
-		"movq %%r15, 0(%%rax)\n"
-		"movq %%r14, 8(%%rax)\n"
-		"movq %%r13, 16(%%rax)\n"
-		"movq %%r12, 24(%%rax)\n"
-		"movq %%r11, 32(%%rax)\n"
-		"movq %%r10, 40(%%rax)\n"
-		"movq %%r9, 48(%%rax)\n"
-		"movq %%r8, 56(%%rax)\n"
-		"movq %%rsi, 64(%%rax)\n"
-		"movq %%rdi, 72(%%rax)\n"
-		"movq %%rbp, 80(%%rax)\n"
-		"movq %%rdx, 88(%%rax)\n"
-		"pop %%rbx\n" // Saved rcx
-		"movq %%rbx, 96(%%rax)\n"
-		"pop %%rbx\n" // Saved rbx
-		"movq %%rbx, 104(%%rax)\n"
-		"pop %%rbx\n" // Saved rax
-		"movq %%rbx, 112(%%rax)\n"
-		"addq $120, %%rax\n"
-		"movw %%es, (%%rax)\n"
-		"movw %%ds, 8(%%rax)\n"
-		"addq $32, %%rax\n"
-		"call __next\n" // read the current rip.
-		"__next:\n"
-		"pop %%rbx\n"
-		"addq $(out_iret -  __next), %%rbx\n"
-		"movq %%rbx, 0(%%rax)\n" // rip
-		"movw %%cs, 8(%%rax)\n"	 // cs
-		"pushfq\n"
-		"popq %%rbx\n"
-		"mov %%rbx, 16(%%rax)\n" // eflags
-		"mov %%rsp, 24(%%rax)\n" // rsp
-		"movw %%ss, 32(%%rax)\n"
-		"mov %%rcx, %%rdi\n"
-		"call do_iret\n"
-		"out_iret:\n"
-		: : "g"(tf_cur), "g"(tf) : "memory");
+	/* NOTE: [Improve] 커널 모드끼리의 전환이므로 intr_frame 전체를 저장하고
+	 * iretq로 돌아가는 대신 callee-saved 레지스터와 rsp만 바꾼다.
+	 * 현재 쓰레드는 나중에 이 호출에서 돌아오는 것으로 다시 실행된다. */
+	thread_switch(&running_thread()->ctx_rsp, th->ctx_rsp);
 }
 
 /* Schedules a new process. At entry, interrupts must be off.
@@ -747,7 +1125,8 @@ do_schedule(int status)
 	{
 		struct thread *victim =
 			list_entry(list_pop_front(&destruction_req), struct thread, elem);
-		palloc_free_page(victim);
+		slab_free(&thread_ext_cache, victim->ext);
+		thread_page_free(victim);
 	}
 	thread_current()->status = status;
 	schedule();
@@ -765,6 +1144,29 @@ schedule(void)
 	/* Mark us as running. */
 	next->status = THREAD_RUNNING;
 
+	/* NOTE: [Improve] 전환 이벤트 및 대기 시간 기록 */
+	if (curr != next)
+	{
+		sched_trace_event(SCHED_SWITCH, curr->tid, curr->priority, next->tid);
+		sched_trace_run(next);
+
+		/* NOTE: [Improve] READY로 내려온 경우는 선점(비자발적), 그 외는 대기로 인한 자발적 전환 */
+		if (curr->status == THREAD_READY)
+			curr->ext->ru.ru_nivcsw++;
+		else if (curr->status == THREAD_BLOCKED)
+		{
+			curr->ext->ru.ru_nvcsw++;
+
+			/* NOTE: [Improve] slice가 남은 채 block되는 쓰레드는 대화형으로 보고 slice를 줄인다 */
+			if (curr != idle_thread && thread_ticks < thread_slice(curr))
+			{
+				slice_surrendered_cnt++;
+				if (curr->slice_shift > 0)
+					curr->slice_shift--;
+			}
+		}
+	}
+
 	/* Start new time slice. */
 	thread_ticks = 0;
 
@@ -795,6 +1197,95 @@ schedule(void)
 	}
 }
 
+/* NOTE: [Improve] 쓰레드 페이지를 캐시에서 꺼내거나, 없으면 새로 할당 */
+static struct thread *thread_page_alloc(void)
+{
+	struct thread *t = NULL;
+	enum intr_level old_level = intr_disable();
+
+	if (!list_empty(&thread_cache))
+	{
+		t = list_entry(list_pop_front(&thread_cache), struct thread, elem);
+		thread_cache_cnt--;
+		thread_cache_hits++;
+	}
+	else
+		thread_cache_misses++;
+	intr_set_level(old_level);
+
+	/* 재사용하는 페이지는 init_thread()가 struct thread 부분을 초기화하므로 zeroing 생략 */
+	if (t == NULL)
+		t = palloc_get_page(PAL_ZERO);
+	return t;
+}
+
+/* NOTE: [Improve] 쓰레드 페이지를 캐시에 반납하고, 캐시가 가득 찼으면 해제 */
+static void thread_page_free(struct thread *t)
+{
+	enum intr_level old_level = intr_disable();
+
+	t->magic = 0;
+	if (thread_cache_cnt < THREAD_CACHE_MAX)
+	{
+		list_push_front(&thread_cache, &t->elem);
+		thread_cache_cnt++;
+		t = NULL;
+	}
+	intr_set_level(old_level);
+
+	if (t != NULL)
+		palloc_free_page(t);
+}
+
+/**
+ * @brief 비어있는 파일 디스크립터 테이블을 할당하는 함수
+ * 캐시에 반납된 페이지가 있으면 FDT_MAX개의 엔트리만 0으로 초기화하여 재사용한다.
+ *
+ * @return struct file** 할당된 FDT (실패 시 NULL)
+ */
+struct file **thread_fdt_alloc(void)
+{
+	struct file **fdt = NULL;
+	enum intr_level old_level = intr_disable();
+
+	if (!list_empty(&fdt_cache))
+	{
+		fdt = (struct file **)list_pop_front(&fdt_cache);
+		fdt_cache_cnt--;
+		fdt_cache_hits++;
+	}
+	else
+		fdt_cache_misses++;
+	intr_set_level(old_level);
+
+	if (fdt != NULL)
+		memset(fdt, 0, FDT_MAX * sizeof *fdt);
+	else
+		fdt = palloc_get_page(PAL_ZERO);
+	return fdt;
+}
+
+/* NOTE: [Improve] 파일 디스크립터 테이블 FDT를 캐시에 반납하고, 캐시가 가득 찼으면 해제 */
+void thread_fdt_free(struct file **fdt)
+{
+	enum intr_level old_level;
+
+	if (fdt == NULL)
+		return;
+
+	old_level = intr_disable();
+	if (fdt_cache_cnt < THREAD_CACHE_MAX)
+	{
+		list_push_front(&fdt_cache, (struct list_elem *)fdt);
+		fdt_cache_cnt++;
+		fdt = NULL;
+	}
+	intr_set_level(old_level);
+
+	if (fdt != NULL)
+		palloc_free_page(fdt);
+}
+
 /* Returns a tid to use for a new thread. */
 static tid_t
 allocate_tid(void)
@@ -809,38 +1300,79 @@ allocate_tid(void)
 	return tid;
 }
 
-static int64_t get_min_tick(void)
+/**
+ * @brief 두 sleep heap을 하나로 합치는 함수
+ * wakeup_tick이 작은 쪽이 루트가 되고, 다른 쪽은 루트의 첫 번째 자식이 된다.
+ *
+ * @param a 첫 번째 heap의 루트 (NULL 가능)
+ * @param b 두 번째 heap의 루트 (NULL 가능)
+ * @return struct thread* 합쳐진 heap의 루트
+ */
+static struct thread *sleep_heap_meld(struct thread *a, struct thread *b)
 {
-	if (list_empty(&sleep_list))
-		return INT64_MAX;
-	return list_entry(list_min(&sleep_list, wakeup_less, NULL), struct thread, elem)->wakeup_tick;
-}
+	struct thread *tmp;
 
-static int set_global_tick(int64_t tick)
-{
-	if (global_tick <= tick) /* 입력받은 tick이 global_tick보다 크면 예외처리 */
-		return 0;
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
 
-	/* global_tick 갱신 */
-	global_tick = tick;
-	return 1;
+	/* 같은 tick이면 먼저 잠든 쪽(a)을 루트로 유지 */
+	if (b->wakeup_tick < a->wakeup_tick)
+	{
+		tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	b->sleep_sibling = a->sleep_child;
+	a->sleep_child = b;
+	return a;
 }
 
 /**
- * @brief 두 쓰레드의 깨어날 시간을 비교하는 함수
+ * @brief sleep heap에서 wakeup_tick이 가장 작은 쓰레드를 꺼내는 함수
+ * 루트의 자식들을 왼쪽부터 두 개씩 합친 뒤(1st pass), 오른쪽부터 다시 합친다(2nd pass).
  *
- * @param a_ 첫 번째 쓰레드의 리스트 요소
- * @param b_ 두 번째 쓰레드의 리스트 요소
- * @param UNUSED 사용되지 않는 매개변수
- * @return true 첫 번째 쓰레드의 깨어날 시간이 두 번째 쓰레드의 깨어날 시간보다 이전인 경우
- * @return false 그렇지 않은 경우
+ * @return struct thread* 가장 먼저 깨어나야 하는 쓰레드
  */
-static bool wakeup_less(const struct list_elem *a_, const struct list_elem *b_, void *aux UNUSED)
+static struct thread *sleep_heap_pop(void)
 {
-	const struct thread *a = list_entry(a_, struct thread, elem);
-	const struct thread *b = list_entry(b_, struct thread, elem);
+	struct thread *min = sleep_heap;
+	struct thread *pairs = NULL;
+	struct thread *a, *b, *next, *root;
 
-	return a->wakeup_tick < b->wakeup_tick;
+	ASSERT(min != NULL);
+
+	/* 1st pass: 자식들을 두 개씩 합쳐 역순 리스트(pairs)에 쌓음 */
+	a = min->sleep_child;
+	while (a != NULL)
+	{
+		b = a->sleep_sibling;
+		next = b != NULL ? b->sleep_sibling : NULL;
+		a->sleep_sibling = NULL;
+		if (b != NULL)
+			b->sleep_sibling = NULL;
+
+		a = sleep_heap_meld(a, b);
+		a->sleep_sibling = pairs;
+		pairs = a;
+		a = next;
+	}
+
+	/* 2nd pass: 오른쪽(마지막 쌍)부터 하나의 heap으로 합침 */
+	root = NULL;
+	while (pairs != NULL)
+	{
+		next = pairs->sleep_sibling;
+		pairs->sleep_sibling = NULL;
+		root = sleep_heap_meld(root, pairs);
+		pairs = next;
+	}
+
+	sleep_heap = root;
+	min->sleep_child = NULL;
+	return min;
 }
 
 /* NOTE: priority-insert-ordered
@@ -862,32 +1394,80 @@ bool compare_priority(struct list_elem *a, struct list_elem *b, void *aux UNUSED
 }
 
 /* NOTE: [1.3] recent_cpu와 nice를 이용해 priority를 계산하는 함수 구현 */
-void thread_calc_priority(struct thread *t)
+static int mlfqs_priority(struct thread *t)
 {
+	/* NOTE: [Improve] 커널 worker 등 우선순위가 고정된 쓰레드는 재계산하지 않음 */
+	if (t->fixed_priority)
+		return t->priority;
+
 	fixed_point quarter_cpu = div_fp(t->recent_cpu, int_to_fp(4));
 	int cpu_to_priority = fp_to_int_round_zero(quarter_cpu);
 	int nice_to_priority = t->nice * 2;
+	int priority = PRI_MAX - cpu_to_priority - nice_to_priority;
+
+	/* 우선순위가 PRI_MIN ~ PRI_MAX 범위를 벗어나지 않도록 보정 */
+	if (priority < PRI_MIN)
+		priority = PRI_MIN;
+	else if (priority > PRI_MAX)
+		priority = PRI_MAX;
 
-	t->priority = PRI_MAX - cpu_to_priority - nice_to_priority;
+	return priority;
 }
 
-/* NOTE: [1.3] recent_cpu를 계산하는 함수 구현 */
+/* NOTE: [1.3] 쓰레드 T의 우선순위를 재계산하여 반영 */
+void thread_calc_priority(struct thread *t)
+{
+	thread_change_priority(t, mlfqs_priority(t));
+}
+
+/**
+ * @brief 쓰레드 T의 recent_cpu에 아직 적용되지 않은 decay를 모두 적용하는 함수
+ *
+ * 최근 DECAY_HISTORY 초 동안의 decay는 기록된 계수로 정확히 적용하고,
+ * 그보다 오래된 부분은 가장 오래된 계수가 유지되었다고 보고
+ * recent_cpu = d^k * recent_cpu + nice * (1 - d^k) / (1 - d) 로 한 번에 계산한다.
+ *
+ * @param t recent_cpu를 갱신할 쓰레드
+ */
 void thread_calc_recent_cpu(struct thread *t)
 {
-	/* 계산에 필요한 정수를 고정 소수점 값으로 변경 */
+	int64_t missed = mlfqs_seconds - t->recent_cpu_sec;
+	fixed_point nice_fp = int_to_fp(t->nice);
 	fixed_point one = int_to_fp(1);
-	fixed_point two = int_to_fp(2);
 
-	/* decay 계산 */
-	fixed_point double_load_avg = mul_fp(two, load_avg);
-	fixed_point double_load_avg_plus_one = add_fp(double_load_avg, one);
-	fixed_point decay = div_fp(double_load_avg, double_load_avg_plus_one);
+	if (missed > DECAY_HISTORY)
+	{
+		int64_t k = missed - DECAY_HISTORY;
+		fixed_point d = decay_history[mlfqs_seconds % DECAY_HISTORY];
+		fixed_point d_k = pow_fp(d, k);
+		fixed_point geometric = div_fp(sub_fp(one, d_k), sub_fp(one, d));
 
-	/* 감쇄된 recent_cpu 및 고정 소수점 값으로 변환한 nice */
-	fixed_point decayed_recent_cpu = mul_fp(decay, t->recent_cpu);
-	fixed_point nice_fp = int_to_fp(t->nice);
+		t->recent_cpu = add_fp(mul_fp(d_k, t->recent_cpu), mul_fp(nice_fp, geometric));
+		missed = DECAY_HISTORY;
+	}
+
+	/* 최근 missed 초 동안의 decay를 오래된 것부터 차례로 적용 */
+	for (int64_t sec = mlfqs_seconds - missed; sec < mlfqs_seconds; sec++)
+	{
+		fixed_point decay = decay_history[sec % DECAY_HISTORY];
+		t->recent_cpu = add_fp(mul_fp(decay, t->recent_cpu), nice_fp);
+	}
+	t->recent_cpu_sec = mlfqs_seconds;
+}
+
+/* NOTE: [Improve] 고정 소수점 값 X의 N제곱 (N >= 0) */
+static fixed_point pow_fp(fixed_point x, int64_t n)
+{
+	fixed_point result = int_to_fp(1);
 
-	t->recent_cpu = add_fp(decayed_recent_cpu, nice_fp);
+	while (n > 0)
+	{
+		if (n & 1)
+			result = mul_fp(result, x);
+		x = mul_fp(x, x);
+		n >>= 1;
+	}
+	return result;
 }
 
 /* NOTE: [1.3] load_avg를 계산하는 함수 구현 */
@@ -897,8 +1477,8 @@ void calc_load_avg()
 	fixed_point weight_59 = div_fp(int_to_fp(59), int_to_fp(60));
 	fixed_point weight_1 = div_fp(int_to_fp(1), int_to_fp(60));
 
-	/* read_thread 계산: ready_list에 담긴 쓰레드의 개수 + 실행 중인 쓰레드의 개수 (idle 제외) */
-	fixed_point count_ready_threads = int_to_fp(list_size(&ready_list));
+	/* read_thread 계산: ready queue에 담긴 쓰레드의 개수 + 실행 중인 쓰레드의 개수 (idle 제외) */
+	fixed_point count_ready_threads = int_to_fp(ready_rq.cnt);
 	if (thread_current() != idle_thread)
 		count_ready_threads = add_fp(count_ready_threads, int_to_fp(1));
 
@@ -918,36 +1498,260 @@ void thread_incr_recent_cpu()
 		curr->recent_cpu = add_fp(curr->recent_cpu, int_to_fp(1));
 }
 
-/* NOTE: [1.3/Improve] `모든` 쓰레드의 우선순위를 재계산하는 함수 구현 */
-void thread_all_calc_priority()
+/**
+ * @brief 1초마다 (타이머 인터럽트에서) 호출되어 recent_cpu decay를 진행하는 함수
+ *
+ * 이번 초의 decay 계수를 기록한 뒤, 실행 중인 쓰레드에만 즉시 적용한다.
+ * READY 상태의 쓰레드는 전부 훑어야 하므로 WQ_HIGH worker에게 넘겨 인터럽트 밖에서 처리하고,
+ * BLOCKED 상태의 쓰레드는 thread_unblock()에서 지연 적용된다.
+ */
+void thread_ready_calc_recent_cpu(void)
 {
-	struct list_elem *e;
-	struct thread *t;
+	fixed_point one = int_to_fp(1);
+	fixed_point two = int_to_fp(2);
+	struct thread *curr = thread_current();
+
+	ASSERT(intr_get_level() == INTR_OFF);
+
+	/* decay 계산 및 기록 */
+	fixed_point double_load_avg = mul_fp(two, load_avg);
+	fixed_point double_load_avg_plus_one = add_fp(double_load_avg, one);
+	decay_history[mlfqs_seconds % DECAY_HISTORY] = div_fp(double_load_avg, double_load_avg_plus_one);
+	mlfqs_seconds++;
 
-	e = list_begin(&all_list);
-	while (e != list_end(&all_list))
+	if (curr != idle_thread)
 	{
-		t = list_entry(e, struct thread, all_elem);
-		thread_calc_priority(t);
-		e = list_next(e);
+		thread_calc_recent_cpu(curr);
+		thread_calc_priority(curr);
 	}
+
+	if (mlfqs_work.func == NULL)
+		work_init(&mlfqs_work, mlfqs_ready_update, NULL);
+	work_queue(WQ_HIGH, &mlfqs_work);
 }
 
-/* NOTE: [1.3/Improve] `모든` 쓰레드의 recent_cpu를 재계산하는 함수 구현 */
-void thread_all_calc_recent_cpu()
+/**
+ * @brief READY 상태의 쓰레드들에 recent_cpu decay를 적용하고 우선순위를 재계산하는 함수 (WQ_HIGH worker에서 실행)
+ *
+ * 인터럽트를 끈 구간이 READY 쓰레드 수에 비례해 길어지지 않도록, 한 번에 최대 MLFQS_UPDATE_BATCH개만
+ * 갱신하고 사이사이 인터럽트를 다시 켠다. 우선순위가 바뀐 쓰레드만 새 queue로 옮기고,
+ * 그대로인 쓰레드는 제자리에 두므로 queue 안의 round-robin 순서는 바뀌지 않는다.
+ *
+ * 각 queue에서 처리할 쓰레드 수는 시작할 때의 queue_cnt로 정해 두고, 마지막으로 본 쓰레드(cursor) 다음부터 이어간다.
+ * 배치 사이에 run queue에서 빠진 쓰레드가 있으면 (remove_seq가 바뀌었으면) cursor가 더는 queue에 없을 수 있으므로
+ * queue 앞부터 다시 훑되, 이미 갱신한 쓰레드 (recent_cpu_sec == mlfqs_seconds)는 세지 않고 건너뛴다.
+ * 배치 사이에 READY가 된 쓰레드는 thread_unblock()에서 이미 갱신되었으므로 역시 건너뛴다.
+ */
+static void mlfqs_ready_update(void *aux UNUSED)
 {
-	struct list_elem *e;
-	struct thread *t;
+	struct runqueue *rq = &ready_rq;
+	size_t left[PRI_MAX + 1];
+	struct thread *cursor = NULL;
+	uint64_t seq;
+	int pri = PRI_MAX;
+	enum intr_level old_level;
+
+	old_level = intr_disable();
+	for (int i = PRI_MIN; i <= PRI_MAX; i++)
+		left[i] = rq->queue_cnt[i];
+	seq = rq->remove_seq;
+	intr_set_level(old_level);
 
-	e = list_begin(&all_list);
-	while (e != list_end(&all_list))
+	while (pri >= PRI_MIN)
 	{
-		t = list_entry(e, struct thread, all_elem);
-		thread_calc_recent_cpu(t);
-		e = list_next(e);
+		int budget = MLFQS_UPDATE_BATCH;
+
+		old_level = intr_disable();
+		if (rq->remove_seq != seq)
+			cursor = NULL;
+		while (pri >= PRI_MIN && budget > 0)
+		{
+			struct list *queue = &rq->queues[pri];
+			struct list_elem *e = cursor != NULL ? list_next(&cursor->elem) : list_begin(queue);
+			struct thread *t;
+			int new_priority;
+
+			if (left[pri] == 0 || e == list_end(queue))
+			{
+				pri--;
+				cursor = NULL;
+				continue;
+			}
+			t = list_entry(e, struct thread, elem);
+			if (t->recent_cpu_sec == mlfqs_seconds)
+			{
+				cursor = t;
+				continue;
+			}
+
+			left[pri]--;
+			budget--;
+			thread_calc_recent_cpu(t);
+			new_priority = mlfqs_priority(t);
+			if (new_priority == t->priority)
+			{
+				cursor = t;
+				continue;
+			}
+
+			/* 다른 queue로 옮기므로 cursor는 그대로 (다음은 T 뒤에 있던 쓰레드) */
+			ready_queue_remove(rq, t);
+			t->priority = new_priority;
+			/* cond_wait()에서 lock을 놓다가 선점된 쓰레드는 대기자 heap에도 들어가 있음 */
+			waiter_heap_update(t);
+			ready_queue_push(rq, t);
+		}
+		seq = rq->remove_seq;
+		intr_set_level(old_level);
 	}
 }
 
+/* NOTE: [Improve] nice에 해당하는 T의 CFS weight */
+static uint64_t cfs_weight(struct thread *t)
+{
+	int nice = t->nice;
+
+	if (nice < -20)
+		nice = -20;
+	else if (nice > 20)
+		nice = 20;
+	return cfs_nice_weight[nice + 20];
+}
+
+/**
+ * @brief 깨어나는 쓰레드 T의 vruntime을 RQ 기준으로 맞추는 함수
+ * 오래 잠들었던 쓰레드가 작은 vruntime으로 CPU를 독차지하지 않도록,
+ * min_vruntime보다 CFS_SLEEPER_CREDIT 이상 뒤처지지 않게 끌어올린다.
+ */
+static void cfs_place(struct runqueue *rq, struct thread *t)
+{
+	uint64_t floor = rq->min_vruntime > CFS_SLEEPER_CREDIT ? rq->min_vruntime - CFS_SLEEPER_CREDIT : 0;
+
+	if (t->vruntime < floor)
+		t->vruntime = floor;
+}
+
+/**
+ * @brief 실행 중인 쓰레드 CURR의 vruntime을 1 tick 만큼 늘리고 선점 여부를 정하는 함수 (thread_tick()에서 호출)
+ *
+ * CURR가 실행 가능한 쓰레드들 중 weight 비율만큼의 몫(CFS_LATENCY 기준, 최소 CFS_MIN_GRANULARITY)을
+ * 다 썼고, 더 작은 vruntime의 쓰레드가 기다리고 있으면 선점한다.
+ *
+ * @param curr 실행 중인 쓰레드
+ * @return true 선점해야 하는 경우
+ */
+static bool cfs_tick(struct thread *curr)
+{
+	struct runqueue *rq = &ready_rq;
+	uint64_t weight = cfs_weight(curr);
+	uint64_t slice, min;
+	struct rb_node *first;
+
+	curr->vruntime += CFS_TICK * CFS_NICE_0_WEIGHT / weight;
+
+	/* min_vruntime은 줄어들지 않음 */
+	first = rb_first(&rq->cfs_tree);
+	min = curr->vruntime;
+	if (first != NULL && rb_entry(first, struct thread, cfs_node)->vruntime < min)
+		min = rb_entry(first, struct thread, cfs_node)->vruntime;
+	if (min > rq->min_vruntime)
+		rq->min_vruntime = min;
+
+	if (first == NULL)
+		return false;
+
+	slice = CFS_LATENCY * weight / (rq->cfs_load + weight);
+	if (slice < CFS_MIN_GRANULARITY)
+		slice = CFS_MIN_GRANULARITY;
+	return thread_ticks >= slice && rb_entry(first, struct thread, cfs_node)->vruntime < curr->vruntime;
+}
+
+/**
+ * @brief 쓰레드 T에게 줄 time slice를 구하는 함수
+ *
+ * 우선순위 구간별 기본값(slice_table)에 T가 최근 slice를 소진했는지, 양보했는지에 따라
+ * 조정된 slice_shift를 적용한다.
+ *
+ * @param t 대상 쓰레드
+ * @return time slice (tick)
+ */
+static unsigned thread_slice(const struct thread *t)
+{
+	return slice_table[(t->priority - PRI_MIN) / SLICE_BAND_WIDTH] << t->slice_shift;
+}
+
+/* NOTE: [Improve] vruntime이 작은 쪽이 먼저 (같으면 먼저 들어온 쪽) */
+static bool cfs_less(const struct rb_node *a_, const struct rb_node *b_, void *aux UNUSED)
+{
+	return rb_entry(a_, struct thread, cfs_node)->vruntime < rb_entry(b_, struct thread, cfs_node)->vruntime;
+}
+
+/* NOTE: [Improve] EDF 쓰레드 T의 새 주기를 START tick부터 시작 */
+static void edf_new_period(struct thread *t, int64_t start)
+{
+	t->edf_deadline = start + t->edf_rel_deadline;
+	t->edf_next_period = start + t->edf_period;
+	t->edf_budget = t->edf_runtime;
+	t->edf_missed = false;
+}
+
+/**
+ * @brief 매 tick마다 EDF 클래스를 관리하는 함수 (thread_tick()에서 호출)
+ *
+ * - 다음 주기가 된 throttled 쓰레드에 runtime을 다시 채워 run queue에 넣는다.
+ * - 실행 중인 EDF 쓰레드의 주기를 갱신하고, deadline을 넘겼으면 miss로 센다.
+ * - 실행 중인 EDF 쓰레드가 이번 주기의 runtime을 다 썼다면 다음 주기까지 멈추게 한다.
+ *
+ * @param curr 실행 중인 쓰레드
+ * @param now 현재 tick
+ */
+static void edf_tick(struct thread *curr, int64_t now)
+{
+	while (!list_empty(&edf_throttled_list))
+	{
+		struct thread *t = list_entry(list_front(&edf_throttled_list), struct thread, elem);
+		if (t->edf_next_period > now)
+			break;
+
+		list_pop_front(&edf_throttled_list);
+		t->edf_throttled = false;
+		edf_new_period(t, t->edf_next_period);
+		thread_unblock(t);
+	}
+
+	if (curr->edf)
+	{
+		if (now >= curr->edf_next_period)
+			edf_new_period(curr, curr->edf_next_period);
+		if (now > curr->edf_deadline && !curr->edf_missed)
+		{
+			curr->edf_missed = true;
+			edf_miss_cnt++;
+		}
+		if (--curr->edf_budget <= 0)
+		{
+			curr->edf_throttled = true;
+			edf_throttle_cnt++;
+		}
+	}
+
+	/* 실행 중인 쓰레드보다 먼저 실행되어야 할 EDF 쓰레드가 있으면 바로 선점 */
+	if (intr_context() && (curr->edf_throttled || (!list_empty(&ready_rq.edf_queue) && ready_queue_preempts(&ready_rq, curr))))
+		intr_yield_on_return();
+}
+
+/* NOTE: [Improve] 절대 deadline이 이른 쪽이 먼저 (같으면 먼저 들어온 쪽) */
+static bool edf_deadline_less(const struct list_elem *a_, const struct list_elem *b_, void *aux UNUSED)
+{
+	return list_entry(a_, struct thread, elem)->edf_deadline < list_entry(b_, struct thread, elem)->edf_deadline;
+}
+
+/* NOTE: [Improve] 다음 주기가 이른 쪽이 먼저 */
+static bool edf_period_less(const struct list_elem *a_, const struct list_elem *b_, void *aux UNUSED)
+{
+	return list_entry(a_, struct thread, elem)->edf_next_period < list_entry(b_, struct thread, elem)->edf_next_period;
+}
+
 /* NOTE: [2.3] 자식 프로세스 검색 함수 구현 */
 struct thread *get_child_process(tid_t tid)
 {
@@ -0,0 +1,169 @@
+/**
+ * NOTE: [Improve] Kernel work queues
+ *
+ * 인터럽트 핸들러는 work를 등록만 하고 바로 돌아가며, 실제 작업은
+ * 우선순위별 worker 쓰레드가 인터럽트가 켜진 상태에서 실행한다.
+ *
+ * 등록은 lock 없이 원자적 compare-and-swap으로 목록 head에 push 하므로
+ * 인터럽트 핸들러를 포함해 어디서든 호출할 수 있다.  worker는 목록 전체를
+ * 한 번에 떼어 와서 등록된 순서대로 실행한다.
+ */
+
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+
+/* worker 쓰레드 하나와 그 대기 목록 */
+struct workqueue
+{
+	const char *name;			/* worker 쓰레드 이름 */
+	int priority;				/* worker 쓰레드 우선순위 */
+	struct work *volatile head; /* 대기 중인 work (나중에 등록된 것이 앞) */
+	struct thread *worker;		/* worker 쓰레드 (만들어지기 전에는 NULL) */
+	bool sleeping;				/* worker가 일이 없어 잠들어 있으면 true */
+	long long queued;			/* 등록된 work 수 */
+	long long executed;			/* 실행한 work 수 */
+};
+
+static struct workqueue workqueues[WQ_CNT] = {
+	[WQ_HIGH] = {.name = "kworker/high", .priority = PRI_MAX},
+	[WQ_NORMAL] = {.name = "kworker", .priority = PRI_DEFAULT},
+};
+
+static thread_func worker_main;
+static struct work *workqueue_take(struct workqueue *);
+
+/* Starts a worker thread for each work queue.
+   Work queued before this is run once the workers start. */
+void workqueue_init(void)
+{
+	for (int i = 0; i < WQ_CNT; i++)
+	{
+		struct workqueue *wq = &workqueues[i];
+		if (thread_create(wq->name, wq->priority, worker_main, wq) == TID_ERROR)
+			PANIC("cannot start %s", wq->name);
+	}
+}
+
+/* Initializes W to run FUNC(AUX) when queued. */
+void work_init(struct work *w, work_func *func, void *aux)
+{
+	ASSERT(w != NULL);
+	ASSERT(func != NULL);
+
+	w->next = NULL;
+	w->func = func;
+	w->aux = aux;
+	w->pending = false;
+}
+
+/**
+ * @brief W를 work queue ID에 등록하는 함수
+ * 인터럽트 핸들러에서도 호출할 수 있다. 이미 등록되어 아직 실행되지 않은 work면 아무것도 하지 않는다.
+ *
+ * @param id 등록할 work queue
+ * @param w 등록할 work
+ * @return true 새로 등록한 경우
+ * @return false 이미 등록되어 있던 경우
+ */
+bool work_queue(enum workqueue_id id, struct work *w)
+{
+	struct workqueue *wq = &workqueues[id];
+	struct work *head;
+	enum intr_level old_level;
+
+	ASSERT(id < WQ_CNT);
+	ASSERT(w != NULL);
+
+	if (__atomic_exchange_n(&w->pending, true, __ATOMIC_ACQ_REL))
+		return false;
+
+	head = __atomic_load_n(&wq->head, __ATOMIC_RELAXED);
+	do
+		w->next = head;
+	while (!__atomic_compare_exchange_n(&wq->head, &head, w, true,
+										__ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	/* 잠든 worker 깨우기 */
+	old_level = intr_disable();
+	wq->queued++;
+	if (wq->sleeping)
+	{
+		wq->sleeping = false;
+		thread_unblock(wq->worker);
+		if (intr_context())
+		{
+			if (wq->priority > thread_current()->priority)
+				intr_yield_on_return();
+		}
+		else
+			thread_compare_yield();
+	}
+	intr_set_level(old_level);
+	return true;
+}
+
+/* Prints work queue statistics. */
+void workqueue_print_stats(void)
+{
+	for (int i = 0; i < WQ_CNT; i++)
+		printf("Workqueue %s: %lld queued, %lld executed\n",
+			   workqueues[i].name, workqueues[i].queued, workqueues[i].executed);
+}
+
+/* NOTE: [Improve] WQ에 대기 중인 work를 모두 떼어 와서 등록된 순서로 돌려줌 */
+static struct work *workqueue_take(struct workqueue *wq)
+{
+	struct work *w = __atomic_exchange_n(&wq->head, NULL, __ATOMIC_ACQUIRE);
+	struct work *fifo = NULL;
+
+	while (w != NULL)
+	{
+		struct work *next = w->next;
+		w->next = fifo;
+		fifo = w;
+		w = next;
+	}
+	return fifo;
+}
+
+/* worker 쓰레드.  대기 중인 work를 실행하고, 없으면 잠든다. */
+static void worker_main(void *wq_)
+{
+	struct workqueue *wq = wq_;
+	struct thread *curr = thread_current();
+	enum intr_level old_level;
+
+	/* MLFQS에서도 우선순위가 다시 계산되지 않도록 고정 */
+	curr->fixed_priority = true;
+	thread_change_priority(curr, wq->priority);
+	wq->worker = curr;
+
+	for (;;)
+	{
+		struct work *w = workqueue_take(wq);
+
+		while (w != NULL)
+		{
+			struct work *next = w->next;
+			work_func *func = w->func;
+			void *aux = w->aux;
+
+			/* 실행 도중에 다시 등록될 수 있도록 먼저 pending을 내림 */
+			__atomic_store_n(&w->pending, false, __ATOMIC_RELEASE);
+			func(aux);
+			wq->executed++;
+			w = next;
+		}
+
+		old_level = intr_disable();
+		if (wq->head == NULL)
+		{
+			wq->sleeping = true;
+			thread_block();
+		}
+		intr_set_level(old_level);
+	}
+}
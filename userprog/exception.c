@@ -4,6 +4,7 @@
 #include "userprog/gdt.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "userprog/syscall.h"
 #include "intrinsic.h"
 
 /* Number of page faults processed. */
@@ -88,7 +89,8 @@ kill(struct intr_frame *f)
 		printf("%s: dying due to interrupt %#04llx (%s).\n",
 			   thread_name(), f->vec_no, intr_name(f->vec_no));
 		intr_dump_frame(f);
-		thread_exit();
+		/* NOTE: [Improve] 쓰레드 하나가 아니라 프로세스 전체를 종료 */
+		exit_group(-1);
 
 	case SEL_KCSEG:
 		/* Kernel's code segment, which indicates a kernel bug.
@@ -142,17 +144,31 @@ page_fault(struct intr_frame *f)
 	write = (f->error_code & PF_W) != 0;
 	user = (f->error_code & PF_U) != 0;
 
+	/* NOTE: [Improve] 쓰레드별 페이지 폴트 횟수 집계 (lazy loading 등으로 처리되는 폴트 포함) */
+	thread_current()->ext->ru.ru_faults++;
 
 #ifdef VM
-	/* For project 3 and later. */
-	if (vm_try_handle_fault(f, fault_addr, user, write, not_present))
+	/* For project 3 and later.
+	   NOTE: [Improve] spt를 공유하는 쓰레드끼리 fault 처리를 직렬화
+	   (mmap 등에서 이미 잡은 채로 커널이 fault를 일으킬 수 있으므로 중복 획득은 피함) */
+	struct lock *vm_lock = &thread_current()->leader->vm_lock;
+	bool locked = !lock_held_by_current_thread(vm_lock);
+	bool handled;
+
+	if (locked)
+		lock_acquire(vm_lock);
+	handled = vm_try_handle_fault(f, fault_addr, user, write, not_present);
+	if (locked)
+		lock_release(vm_lock);
+	if (handled)
 		return;
 #endif
 
 	/* NOTE: [2.4] 페이지 폴트 발생 시 exit(-1) 호출 */
 	/* Count page faults. */
 	page_fault_cnt++;
-	exit(-1);
+	/* NOTE: [Improve] 쓰레드 하나의 fault도 프로세스 전체를 종료 */
+	exit_group(-1);
 
 	/* If the fault is true fault, show info and exit. */
 	printf("Page fault at %p: %s error %s page in %s context.\n",
@@ -0,0 +1,208 @@
+#include "userprog/futex.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* NOTE: [Improve] futex
+   사용자 프로그램이 메모리 word 하나를 두고 잠들고(FUTEX_WAIT) 깨울(FUTEX_WAKE) 수 있게 한다.
+   경쟁이 없을 때는 사용자 공간의 atomic 연산만으로 끝나고, 기다려야 할 때만 커널에 들어온다.
+
+   futex는 (주소 공간, 사용자 가상 주소)로 구분한다. 주소 공간은 pml4/spt를 소유한
+   leader 쓰레드로 나타내므로 uthread_create()로 만든 쓰레드끼리는 같은 futex를 공유하고,
+   fork()한 프로세스끼리는 같은 주소라도 서로 다른 futex가 된다.
+
+   대기자는 futex마다 하나씩 둔 condition에서 잠들기 때문에 (condition의 대기자 heap)
+   FUTEX_WAKE는 우선순위가 가장 높은 쓰레드부터 깨운다. */
+
+#define FUTEX_BUCKET_CNT 64
+
+/* 대기자가 있는 futex 하나 */
+struct futex
+{
+	struct thread *leader; /* 주소 공간 */
+	int *uaddr;			   /* 사용자 가상 주소 */
+	struct condition cond; /* 대기자 (우선순위 heap) */
+	int sleepers;		   /* 아직 깨우지 않은 대기자 수 */
+	int refs;			   /* 이 구조체를 참조 중인 대기자 수 (깨어난 뒤 정리 전까지 포함) */
+	struct list_elem elem; /* bucket 원소 */
+};
+
+/* 같은 hash 값을 가지는 futex 목록 */
+struct futex_bucket
+{
+	struct lock lock;	  /* 목록과 futex 값 비교를 보호 */
+	struct list futexes;  /* 대기자가 있는 futex 목록 */
+};
+
+static struct futex_bucket buckets[FUTEX_BUCKET_CNT];
+
+static struct futex_bucket *futex_bucket(struct thread *leader, int *uaddr);
+static struct futex *futex_lookup(struct futex_bucket *b, struct thread *leader, int *uaddr);
+static bool futex_check_uaddr(int *uaddr);
+
+/* Initializes the futex hash table. */
+void futex_init(void)
+{
+	for (size_t i = 0; i < FUTEX_BUCKET_CNT; i++)
+	{
+		lock_init_named(&buckets[i].lock, "futex_bucket");
+		list_init(&buckets[i].futexes);
+	}
+}
+
+/**
+ * @brief *UADDR가 아직 VAL이면 FUTEX_WAKE로 깨워질 때까지 잠드는 함수
+ * 값 비교와 대기열 등록이 bucket lock 안에서 일어나므로, 값을 바꾼 뒤 FUTEX_WAKE를
+ * 호출하는 쓰레드와 엇갈려 깨움을 놓치는 일은 없다.
+ *
+ * @param uaddr 사용자 메모리의 int (4 byte 정렬)
+ * @param val 잠들기 위해 기대하는 값
+ * @return 깨워졌으면 0, 값이 달라 잠들지 않았거나 UADDR가 잘못되었으면 -1
+ */
+int futex_wait(int *uaddr, int val)
+{
+	struct thread *leader = thread_current()->leader;
+	struct futex_bucket *b;
+	struct futex *f;
+	volatile int *word = uaddr;
+
+	if (!futex_check_uaddr(uaddr))
+		return -1;
+
+	/* lock을 잡기 전에 한 번 읽어 페이지를 올려 둔다.
+	   잘못된 주소라면 여기서 프로세스가 종료되므로 lock을 쥔 채 죽지 않는다. */
+	(void)*word;
+
+	b = futex_bucket(leader, uaddr);
+	lock_acquire(&b->lock);
+	if (*word != val || leader->group_exiting)
+	{
+		lock_release(&b->lock);
+		return -1;
+	}
+
+	f = futex_lookup(b, leader, uaddr);
+	if (f == NULL)
+	{
+		f = malloc(sizeof *f);
+		if (f == NULL)
+		{
+			lock_release(&b->lock);
+			return -1;
+		}
+		f->leader = leader;
+		f->uaddr = uaddr;
+		cond_init(&f->cond);
+		f->sleepers = f->refs = 0;
+		list_push_back(&b->futexes, &f->elem);
+	}
+
+	f->sleepers++;
+	f->refs++;
+	cond_wait(&f->cond, &b->lock);
+
+	/* 깨운 쪽에서 sleepers를 줄였으므로 마지막으로 떠나는 대기자가 정리 */
+	if (--f->refs == 0)
+	{
+		list_remove(&f->elem);
+		free(f);
+	}
+	lock_release(&b->lock);
+	return 0;
+}
+
+/**
+ * @brief UADDR에서 잠든 쓰레드를 우선순위가 높은 순서로 최대 CNT개 깨우는 함수
+ *
+ * @param uaddr 사용자 메모리의 int (4 byte 정렬)
+ * @param cnt 깨울 최대 쓰레드 수
+ * @return 실제로 깨운 쓰레드 수, UADDR가 잘못되었으면 -1
+ */
+int futex_wake(int *uaddr, int cnt)
+{
+	struct thread *leader = thread_current()->leader;
+	struct futex_bucket *b;
+	struct futex *f;
+	int woken = 0;
+
+	if (!futex_check_uaddr(uaddr))
+		return -1;
+
+	b = futex_bucket(leader, uaddr);
+	lock_acquire(&b->lock);
+	f = futex_lookup(b, leader, uaddr);
+	while (f != NULL && woken < cnt && f->sleepers > 0)
+	{
+		cond_signal(&f->cond, &b->lock);
+		f->sleepers--;
+		woken++;
+	}
+	lock_release(&b->lock);
+	return woken;
+}
+
+/**
+ * @brief 종료하는 프로세스 LEADER의 주소 공간에서 잠든 쓰레드를 모두 깨우는 함수
+ * leader->group_exiting이 설정된 뒤에 호출해야 다시 잠드는 쓰레드가 생기지 않는다.
+ *
+ * @param leader 종료하는 프로세스의 leader 쓰레드
+ */
+void futex_release(struct thread *leader)
+{
+	ASSERT(leader->group_exiting);
+
+	for (size_t i = 0; i < FUTEX_BUCKET_CNT; i++)
+	{
+		struct futex_bucket *b = &buckets[i];
+		struct list_elem *e;
+
+		lock_acquire(&b->lock);
+		for (e = list_begin(&b->futexes); e != list_end(&b->futexes); e = list_next(e))
+		{
+			struct futex *f = list_entry(e, struct futex, elem);
+			if (f->leader == leader && f->sleepers > 0)
+			{
+				cond_broadcast(&f->cond, &b->lock);
+				f->sleepers = 0;
+			}
+		}
+		lock_release(&b->lock);
+	}
+}
+
+/* Returns the bucket for the futex at UADDR in LEADER's address
+   space. */
+static struct futex_bucket *
+futex_bucket(struct thread *leader, int *uaddr)
+{
+	uint64_t key[2] = {(uint64_t)leader, (uint64_t)uaddr};
+
+	return &buckets[hash_bytes(key, sizeof key) % FUTEX_BUCKET_CNT];
+}
+
+/* Returns the futex at UADDR in LEADER's address space that has
+   waiters, or a null pointer.  B's lock must be held. */
+static struct futex *
+futex_lookup(struct futex_bucket *b, struct thread *leader, int *uaddr)
+{
+	struct list_elem *e;
+
+	ASSERT(lock_held_by_current_thread(&b->lock));
+	for (e = list_begin(&b->futexes); e != list_end(&b->futexes); e = list_next(e))
+	{
+		struct futex *f = list_entry(e, struct futex, elem);
+		if (f->leader == leader && f->uaddr == uaddr)
+			return f;
+	}
+	return NULL;
+}
+
+/* Returns true if UADDR is an aligned user address. */
+static bool
+futex_check_uaddr(int *uaddr)
+{
+	return uaddr != NULL && is_user_vaddr(uaddr) && ((uintptr_t)uaddr % sizeof *uaddr) == 0;
+}
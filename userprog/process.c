@@ -22,6 +22,7 @@
 #include "threads/loader.h"
 #include "threads/malloc.h"
 #include "userprog/syscall.h"
+#include "userprog/futex.h"
 
 #ifdef VM
 #include "vm/vm.h"
@@ -33,6 +34,26 @@ static bool load(const char *file_name, struct intr_frame *if_);
 static void initd(void *f_name);
 static void __do_fork(void *);
 static void argument_stack(char **parse, int count, void **rsp);
+static void process_record_usage(struct thread *t);
+static void uthread_start(void *aux);
+static bool uthread_stack_map(struct thread *leader, int slot);
+static int uthread_reap(struct thread *t);
+static void uthread_reap_all(struct thread *leader);
+static void uthread_detach(void);
+
+/* NOTE: [Improve] 종료된 프로세스들의 자원 사용량 기록 (종료 시 process_print_stats()로 출력) */
+#define PROCESS_STATS_MAX 64
+
+struct process_stat
+{
+	char name[16];	  /* 프로세스 이름 */
+	tid_t tid;		  /* 프로세스 id */
+	int exit_status;  /* 종료 status */
+	struct rusage ru; /* 자기 자신과 회수한 자식들의 사용량 합 */
+};
+
+static struct process_stat process_stats[PROCESS_STATS_MAX];
+static size_t process_stat_cnt; /* 지금까지 기록된 프로세스 수 (가장 오래된 기록부터 덮어씀) */
 
 /* General process initializer for initd and other process. */
 static void process_init(void)
@@ -88,7 +109,7 @@ initd(void *f_name)
 tid_t process_fork(const char *name, struct intr_frame *if_)
 {
 	struct thread *curr = thread_current();
-	memcpy(&curr->parent_if, if_, sizeof(struct intr_frame));
+	memcpy(&curr->ext->parent_if, if_, sizeof(struct intr_frame));
 
 	/* Clone current thread to new thread.*/
 	tid_t tid = thread_create(name, PRI_DEFAULT, __do_fork, curr);
@@ -154,7 +175,7 @@ __do_fork(void *aux)
 	struct thread *parent = (struct thread *)aux;
 	struct thread *current = thread_current();
 	/* NOTE: somehow pass the parent_if. (i.e. process_fork()'s if_) */
-	struct intr_frame *parent_if = &parent->parent_if;
+	struct intr_frame *parent_if = &parent->ext->parent_if;
 	bool succ = true;
 
 	/* 1. Read the cpu context to local stack. */
@@ -170,7 +191,7 @@ __do_fork(void *aux)
 	process_activate(current);
 #ifdef VM
 	supplemental_page_table_init(&current->spt);
-	if (!supplemental_page_table_copy(&current->spt, &parent->spt))
+	if (!supplemental_page_table_copy(&current->spt, &parent->leader->spt))
 		goto error;
 #else
 	if (!pml4_for_each(parent->pml4, duplicate_pte, parent))
@@ -329,6 +350,10 @@ int process_wait(tid_t child_tid)
 	/* 자식프로세스가 종료될 때까지 부모 프로세스 대기(세마포어 이용) */
 	sema_down(&child->wait_sema);
 
+	/* NOTE: [Improve] 자식과 자식이 회수한 자손들의 자원 사용량을 부모에 합산 */
+	rusage_add(&thread_current()->ext->ru_children, &child->ext->ru);
+	rusage_add(&thread_current()->ext->ru_children, &child->ext->ru_children);
+
 	/* 자식 프로세스 디스크립터 삭제*/
 	exit_status = child->exit_status;
 	list_remove(&child->c_elem);
@@ -343,6 +368,15 @@ void process_exit(void)
 {
 	struct thread *curr = thread_current();
 
+	/* NOTE: [Improve] uthread_create()로 만든 쓰레드는 공유 자원을 건드리지 않고 join만 기다림 */
+	if (curr->leader != curr)
+	{
+		uthread_detach();
+		return;
+	}
+	/* leader는 같은 주소 공간을 쓰는 쓰레드가 모두 끝난 뒤에 자원을 해제 */
+	uthread_reap_all(curr);
+
 	/* NOTE: [2.5] run_file 닫아주기 */
 	file_close(curr->run_file);
 	curr->run_file = NULL;
@@ -350,7 +384,10 @@ void process_exit(void)
 	/* NOTE: [2.4] 모든 열린 파일 닫기 */
 	for (int idx = 2; idx < FDT_MAX; idx++)
 		file_close(process_get_file(idx));
-	palloc_free_page(curr->fdt);
+	thread_fdt_free(curr->fdt);
+	curr->fdt = NULL;
+	if (curr->pml4 != NULL)
+		process_record_usage(curr);
 	process_cleanup();
 
 	/* NOTE: [2.3] thread_exit 수정 */
@@ -359,6 +396,59 @@ void process_exit(void)
 	sema_down(&thread_current()->exit_sema);
 }
 
+/**
+ * @brief 종료하는 프로세스 T의 자원 사용량을 process_stats에 기록하는 함수
+ *
+ * @param t 종료하는 프로세스
+ */
+static void
+process_record_usage(struct thread *t)
+{
+	enum intr_level old_level = intr_disable();
+	struct process_stat *s = &process_stats[process_stat_cnt++ % PROCESS_STATS_MAX];
+
+	strlcpy(s->name, t->name, sizeof s->name);
+	s->tid = t->tid;
+	s->exit_status = t->exit_status;
+	s->ru = t->ext->ru;
+	rusage_add(&s->ru, &t->ext->ru_children);
+	intr_set_level(old_level);
+}
+
+/* Prints per-process resource usage. */
+void process_print_stats(void)
+{
+	struct thread *curr = thread_current();
+	size_t first = process_stat_cnt > PROCESS_STATS_MAX ? process_stat_cnt - PROCESS_STATS_MAX : 0;
+
+	if (process_stat_cnt == 0 && curr->pml4 == NULL)
+		return;
+
+	printf("Process: %zu exited", process_stat_cnt);
+	if (first > 0)
+		printf(" (oldest %zu not shown)", first);
+	printf("\n");
+	printf("  %-16s %5s %6s %7s %7s %7s %7s %7s %8s\n",
+		   "name", "tid", "status", "utime", "stime", "nvcsw", "nivcsw", "faults", "syscalls");
+	for (size_t i = first; i < process_stat_cnt; i++)
+	{
+		struct process_stat *s = &process_stats[i % PROCESS_STATS_MAX];
+		printf("  %-16s %5d %6d %7lld %7lld %7lld %7lld %7lld %8lld\n",
+			   s->name, s->tid, s->exit_status, s->ru.ru_utime, s->ru.ru_stime,
+			   s->ru.ru_nvcsw, s->ru.ru_nivcsw, s->ru.ru_faults, s->ru.ru_nsyscalls);
+	}
+
+	/* 종료(halt)를 요청한 프로세스는 아직 살아있으므로 따로 출력 */
+	if (curr->pml4 != NULL)
+	{
+		struct rusage ru = curr->ext->ru;
+		rusage_add(&ru, &curr->ext->ru_children);
+		printf("  %-16s %5d %6s %7lld %7lld %7lld %7lld %7lld %8lld\n",
+			   curr->name, curr->tid, "-", ru.ru_utime, ru.ru_stime,
+			   ru.ru_nvcsw, ru.ru_nivcsw, ru.ru_faults, ru.ru_nsyscalls);
+	}
+}
+
 /**
  * @brief 현재 프로세스의 자원을 해제하는 함수 /
  * 현재 프로세스의 페이지 테이블을 파괴하고 커널 전용 페이지 테이블로 전환하는 작업을 수행합니다.
@@ -830,7 +920,9 @@ load_segment(struct file *file, off_t ofs, uint8_t *upage,
 		// printf("now in load segment\n");
 		// printf("aux malloc");
 		// printf(" ok\n");
-		struct file_page *aux = (struct file_page *)calloc(1,sizeof(struct file_page));
+		struct file_page *aux = slab_alloc(&file_page_cache);
+		if (aux == NULL)
+			return false;
 		aux->file = file;
 		aux->ofs = ofs;
 		aux->read_bytes = page_read_bytes;
@@ -874,3 +966,285 @@ setup_stack(struct intr_frame *if_)
 	return success;
 }
 #endif /* VM */
+
+/* ---------- 사용자 쓰레드 ---------- */
+
+/* NOTE: [Improve] 한 프로세스가 동시에 가질 수 있는 사용자 쓰레드 수와 쓰레드별 스택 크기.
+   스택 슬롯은 메인 스택이 자랄 수 있는 1MB 바로 아래부터 차례로 배치하고,
+   각 슬롯의 가장 아래 페이지는 overflow를 잡기 위한 guard로 비워 둔다. */
+#define UTHREAD_MAX 16
+#define UTHREAD_STACK_PAGES 16
+#define UTHREAD_STACK_TOP ((uint8_t *)USER_STACK - (1 << 20))
+
+/* 새 쓰레드에게 넘기는 시작 정보 (생성한 쓰레드의 스택에 있음) */
+struct uthread_start_info
+{
+	struct thread *leader;	   /* 주소 공간을 소유한 쓰레드 */
+	struct intr_frame if_;	   /* 사용자 모드로 진입할 때의 레지스터 */
+	int slot;				   /* 사용할 스택 슬롯 */
+	struct semaphore started;  /* 새 쓰레드가 group에 들어가면 up */
+};
+
+/* Returns the top of user stack slot SLOT. */
+static uint8_t *
+uthread_stack_top(int slot)
+{
+	return UTHREAD_STACK_TOP - (size_t)slot * UTHREAD_STACK_PAGES * PGSIZE;
+}
+
+/**
+ * @brief 현재 프로세스의 주소 공간, spt, FDT를 공유하는 새 쓰레드를 만드는 함수
+ * 새 쓰레드는 사용자 모드에서 ENTRY(FUNC, AUX)로 시작한다.
+ *
+ * @param entry 사용자 모드 시작 주소
+ * @param func ENTRY의 첫 번째 인자
+ * @param aux ENTRY의 두 번째 인자
+ * @param if_ 시스템 콜을 호출한 쓰레드의 인터럽트 프레임 (세그먼트, 플래그를 물려받음)
+ * @return 새 쓰레드의 tid, 실패 시 TID_ERROR
+ */
+tid_t process_thread_create(void *entry, void *func, void *aux, struct intr_frame *if_)
+{
+	struct thread *leader = thread_current()->leader;
+	struct uthread_start_info info;
+	enum intr_level old_level;
+	tid_t tid;
+	int slot;
+
+	/* 빈 스택 슬롯 예약 */
+	old_level = intr_disable();
+	for (slot = 0; slot < UTHREAD_MAX; slot++)
+		if ((leader->ustack_used & (1u << slot)) == 0)
+			break;
+	if (slot == UTHREAD_MAX || leader->group_exiting)
+	{
+		intr_set_level(old_level);
+		return TID_ERROR;
+	}
+	leader->ustack_used |= 1u << slot;
+	intr_set_level(old_level);
+
+	if (!uthread_stack_map(leader, slot))
+		goto error;
+
+	info.leader = leader;
+	info.slot = slot;
+	memcpy(&info.if_, if_, sizeof info.if_);
+	info.if_.rip = (uintptr_t)entry;
+	info.if_.R.rdi = (uint64_t)func;
+	info.if_.R.rsi = (uint64_t)aux;
+	info.if_.R.rax = 0;
+	/* 함수 진입 시점처럼 (rsp + 8)이 16 byte 정렬되도록 */
+	info.if_.rsp = (uintptr_t)uthread_stack_top(slot) - sizeof(void *);
+	sema_init(&info.started, 0);
+
+	tid = thread_create(thread_current()->name, PRI_DEFAULT, uthread_start, &info);
+	if (tid == TID_ERROR)
+		goto error;
+	sema_down(&info.started);
+	return tid;
+
+error:
+	old_level = intr_disable();
+	leader->ustack_used &= ~(1u << slot);
+	intr_set_level(old_level);
+	return TID_ERROR;
+}
+
+/**
+ * @brief 같은 프로세스의 쓰레드 TID가 끝나기를 기다렸다가 회수하는 함수
+ *
+ * @param tid 기다릴 쓰레드 (uthread_create()로 만든 쓰레드만 가능)
+ * @return 쓰레드의 종료 status, TID가 없거나 이미 다른 쓰레드가 join 중이면 -1
+ */
+int process_thread_join(tid_t tid)
+{
+	struct thread *curr = thread_current();
+	struct thread *leader = curr->leader;
+	struct thread *t = NULL;
+	enum intr_level old_level;
+	struct list_elem *e;
+
+	old_level = intr_disable();
+	for (e = list_begin(&leader->group); e != list_end(&leader->group); e = list_next(e))
+	{
+		struct thread *c = list_entry(e, struct thread, group_elem);
+		if (c->tid == tid && c != curr && !c->joined)
+		{
+			t = c;
+			t->joined = true;
+			break;
+		}
+	}
+	intr_set_level(old_level);
+
+	if (t == NULL)
+		return -1;
+	return uthread_reap(t);
+}
+
+/* Returns true if the current process has no threads besides the
+   one calling. */
+bool process_single_threaded(void)
+{
+	struct thread *curr = thread_current();
+
+	return curr->leader == curr && list_empty(&curr->group);
+}
+
+/* A thread function that enters user mode for a thread created by
+   process_thread_create(). */
+static void
+uthread_start(void *aux)
+{
+	struct uthread_start_info *info = aux;
+	struct thread *curr = thread_current();
+	struct thread *leader = info->leader;
+	struct intr_frame if_;
+	enum intr_level old_level;
+
+	/* thread_create()가 만든 FDT 대신 leader의 FDT를 공유 */
+	thread_fdt_free(curr->fdt);
+	curr->fdt = leader->fdt;
+	curr->leader = leader;
+	curr->ustack_slot = info->slot;
+	memcpy(&if_, &info->if_, sizeof if_);
+
+	old_level = intr_disable();
+	curr->pml4 = leader->pml4;
+	process_activate(curr);
+	list_push_back(&leader->group, &curr->group_elem);
+	/* 프로세스의 자식이 아니므로 생성한 쓰레드의 child_list에서 빼서 wait()의 대상이 되지 않게 함
+	   (회수는 join이 하며, 남겨 두면 회수된 뒤에도 child_list에 남는다) */
+	list_remove(&curr->c_elem);
+	intr_set_level(old_level);
+
+	/* 이 뒤로 INFO는 생성한 쓰레드의 스택에서 사라질 수 있다 */
+	sema_up(&info->started);
+	do_iret(&if_);
+	NOT_REACHED();
+}
+
+/* Makes sure the pages of stack slot SLOT exist in LEADER's
+   address space.  Pages are kept after the thread exits so the
+   slot can be reused without remapping. */
+static bool
+uthread_stack_map(struct thread *leader, int slot)
+{
+	uint8_t *top = uthread_stack_top(slot);
+	uint8_t *guard = top - UTHREAD_STACK_PAGES * PGSIZE;
+	bool success = true;
+
+	if (leader->ustack_mapped & (1u << slot))
+		return true;
+
+#ifdef VM
+	lock_acquire(&leader->vm_lock);
+	for (uint8_t *va = top - PGSIZE; va > guard && success; va -= PGSIZE)
+		if (spt_find_page(&leader->spt, va) == NULL)
+			success = vm_alloc_page(VM_ANON | STACK_MARKER, va, true);
+	lock_release(&leader->vm_lock);
+#else
+	for (uint8_t *va = top - PGSIZE; va > guard && success; va -= PGSIZE)
+	{
+		uint8_t *kpage;
+
+		if (pml4_get_page(leader->pml4, va) != NULL)
+			continue;
+		kpage = palloc_get_page(PAL_USER | PAL_ZERO);
+		success = kpage != NULL && install_page(va, kpage, true);
+		if (!success && kpage != NULL)
+			palloc_free_page(kpage);
+	}
+#endif
+
+	if (success)
+	{
+		enum intr_level old_level = intr_disable();
+		leader->ustack_mapped |= 1u << slot;
+		intr_set_level(old_level);
+	}
+	return success;
+}
+
+/* Waits for thread T, which must be marked as joined by the caller,
+   to exit, frees it and returns its exit status. */
+static int
+uthread_reap(struct thread *t)
+{
+	enum intr_level old_level;
+	int status;
+
+	sema_down(&t->wait_sema);
+	status = t->exit_status;
+
+	old_level = intr_disable();
+	list_remove(&t->group_elem);
+	intr_set_level(old_level);
+
+	sema_up(&t->exit_sema);
+	return status;
+}
+
+/**
+ * @brief 종료하는 LEADER가 남은 쓰레드를 모두 회수하는 함수
+ * 남은 쓰레드는 사용자 모드로 돌아가기 전에 종료되고 (exit_group_check), futex에서 잠든 쓰레드는 깨워서 종료시킨다.
+ *
+ * @param leader 종료하는 프로세스의 leader 쓰레드
+ */
+static void
+uthread_reap_all(struct thread *leader)
+{
+	leader->group_exiting = true;
+	if (!list_empty(&leader->group))
+		futex_release(leader);
+	for (;;)
+	{
+		enum intr_level old_level = intr_disable();
+		struct thread *t = NULL;
+		struct list_elem *e;
+		bool empty = list_empty(&leader->group);
+
+		for (e = list_begin(&leader->group); e != list_end(&leader->group); e = list_next(e))
+		{
+			struct thread *c = list_entry(e, struct thread, group_elem);
+			if (!c->joined)
+			{
+				t = c;
+				t->joined = true;
+				break;
+			}
+		}
+		intr_set_level(old_level);
+
+		if (t != NULL)
+			uthread_reap(t);
+		else if (empty)
+			break;
+		else
+			/* 남은 쓰레드는 다른 쓰레드가 join 중이므로 그 쪽이 회수할 때까지 양보 */
+			thread_yield();
+	}
+}
+
+/* Called by process_exit() for a thread created by
+   process_thread_create(): gives its stack slot back, drops the
+   shared resources and waits to be reaped. */
+static void
+uthread_detach(void)
+{
+	struct thread *curr = thread_current();
+	struct thread *leader = curr->leader;
+	enum intr_level old_level;
+
+	old_level = intr_disable();
+	leader->ustack_used &= ~(1u << curr->ustack_slot);
+	rusage_add(&leader->ext->ru, &curr->ext->ru);
+	curr->fdt = NULL;
+	/* leader가 pml4를 해제하기 전에 커널 페이지 테이블로 전환 */
+	curr->pml4 = NULL;
+	process_activate(curr);
+	intr_set_level(old_level);
+
+	sema_up(&curr->wait_sema);
+	sema_down(&curr->exit_sema);
+}
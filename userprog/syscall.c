@@ -5,6 +5,7 @@
 #include "threads/thread.h"
 #include "threads/loader.h"
 #include "userprog/gdt.h"
+#include "userprog/tss.h"
 #include "threads/flags.h"
 #include "intrinsic.h"
 /* NOTE: [2.2] 구현에 필요한 라이브러리 include */
@@ -14,11 +15,13 @@
 #include "lib/syscall-nr.h"
 #include "lib/user/syscall.h"
 #include "userprog/process.h"
+#include "userprog/futex.h"
 #include "devices/input.h"
 #include "threads/palloc.h"
 
 void syscall_entry(void);
 void syscall_handler(struct intr_frame *);
+uint64_t syscall_fast_handler(uint64_t a1, uint64_t a2, uint64_t a3, uint64_t syscall_num);
 
 /* System call.
  *
@@ -32,6 +35,7 @@ void syscall_handler(struct intr_frame *);
 #define MSR_STAR 0xc0000081			/* Segment selector msr */
 #define MSR_LSTAR 0xc0000082		/* Long mode SYSCALL target */
 #define MSR_SYSCALL_MASK 0xc0000084 /* Mask for the eflags */
+#define MSR_KERNEL_GS_BASE 0xc0000102 /* GS base swapped in by swapgs */
 
 /* NOTE: [2.2] define */
 #define USER_AREA_STAR 0x8048000
@@ -59,8 +63,97 @@ void munmap(void *addr);
 bool create(const char *file, unsigned initial_size);
 bool remove(const char *file);
 
+/* accounting */
+int getrusage(int who, struct rusage *usage);
+
+/* threads */
+tid_t sys_thread_create(void *entry, void *func, void *aux, struct intr_frame *f);
+int sys_thread_join(tid_t tid);
+int futex(int *uaddr, int op, int val);
+
 void check_address(void *addr);
 
+/* NOTE: [Improve] 시스템 콜 테이블
+ * 번호로 바로 핸들러를 찾는다. intr_frame이 필요한 콜은 slow 핸들러로,
+ * 레지스터 인자만 쓰고 사용자 메모리를 건드리지 않는 콜은 fast 핸들러로 등록한다.
+ * fast 핸들러가 있는 콜은 syscall_entry가 intr_frame을 만들지 않고
+ * syscall_fast_handler()로 바로 보낸다. */
+typedef void syscall_slow_func(struct intr_frame *f);
+typedef uint64_t syscall_fast_func(uint64_t a1, uint64_t a2, uint64_t a3);
+
+struct syscall_desc
+{
+	syscall_slow_func *slow; /* intr_frame을 받는 핸들러 */
+	syscall_fast_func *fast; /* 레지스터 인자만 받는 핸들러 */
+};
+
+static void sc_halt(struct intr_frame *f UNUSED) { halt(); }
+static void sc_exit(struct intr_frame *f) { exit(f->R.rdi); }
+static void sc_fork(struct intr_frame *f) { f->R.rax = sys_fork((const char *)f->R.rdi, f); }
+static void sc_exec(struct intr_frame *f) { f->R.rax = exec((const char *)f->R.rdi); }
+static void sc_wait(struct intr_frame *f) { f->R.rax = wait(f->R.rdi); }
+static void sc_create(struct intr_frame *f) { f->R.rax = create((const char *)f->R.rdi, f->R.rsi); }
+static void sc_remove(struct intr_frame *f) { f->R.rax = remove((const char *)f->R.rdi); }
+static void sc_open(struct intr_frame *f) { f->R.rax = open((const char *)f->R.rdi); }
+static void sc_read(struct intr_frame *f) { f->R.rax = read(f->R.rdi, (void *)f->R.rsi, f->R.rdx); }
+static void sc_write(struct intr_frame *f) { f->R.rax = write(f->R.rdi, (const void *)f->R.rsi, f->R.rdx); }
+static void sc_mmap(struct intr_frame *f) { f->R.rax = (uint64_t)mmap((void *)f->R.rdi, f->R.rsi, f->R.rdx, f->R.r10, f->R.r8); }
+static void sc_munmap(struct intr_frame *f) { munmap((void *)f->R.rdi); }
+static void sc_getrusage(struct intr_frame *f) { f->R.rax = getrusage(f->R.rdi, (struct rusage *)f->R.rsi); }
+static void sc_thread_create(struct intr_frame *f) { f->R.rax = sys_thread_create((void *)f->R.rdi, (void *)f->R.rsi, (void *)f->R.rdx, f); }
+static void sc_thread_join(struct intr_frame *f) { f->R.rax = sys_thread_join(f->R.rdi); }
+static void sc_futex(struct intr_frame *f) { f->R.rax = futex((int *)f->R.rdi, f->R.rsi, f->R.rdx); }
+
+static uint64_t sc_filesize(uint64_t fd, uint64_t a2 UNUSED, uint64_t a3 UNUSED) { return filesize(fd); }
+static uint64_t sc_tell(uint64_t fd, uint64_t a2 UNUSED, uint64_t a3 UNUSED) { return tell(fd); }
+static uint64_t sc_seek(uint64_t fd, uint64_t position, uint64_t a3 UNUSED)
+{
+	seek(fd, position);
+	return 0;
+}
+static uint64_t sc_close(uint64_t fd, uint64_t a2 UNUSED, uint64_t a3 UNUSED)
+{
+	close(fd);
+	return 0;
+}
+
+static const struct syscall_desc syscall_table[] = {
+	[SYS_HALT] = {sc_halt, NULL},
+	[SYS_EXIT] = {sc_exit, NULL},
+	[SYS_FORK] = {sc_fork, NULL},
+	[SYS_EXEC] = {sc_exec, NULL},
+	[SYS_WAIT] = {sc_wait, NULL},
+	[SYS_CREATE] = {sc_create, NULL},
+	[SYS_REMOVE] = {sc_remove, NULL},
+	[SYS_OPEN] = {sc_open, NULL},
+	[SYS_FILESIZE] = {NULL, sc_filesize},
+	[SYS_READ] = {sc_read, NULL},
+	[SYS_WRITE] = {sc_write, NULL},
+	[SYS_SEEK] = {NULL, sc_seek},
+	[SYS_TELL] = {NULL, sc_tell},
+	[SYS_CLOSE] = {NULL, sc_close},
+	[SYS_MMAP] = {sc_mmap, NULL},
+	[SYS_MUNMAP] = {sc_munmap, NULL},
+	[SYS_GETRUSAGE] = {sc_getrusage, NULL},
+	[SYS_THREAD_CREATE] = {sc_thread_create, NULL},
+	[SYS_THREAD_JOIN] = {sc_thread_join, NULL},
+	[SYS_FUTEX] = {sc_futex, NULL},
+};
+#define SYSCALL_CNT (sizeof syscall_table / sizeof syscall_table[0])
+
+/* NOTE: [Improve] fast 핸들러가 있는 시스템 콜 번호의 비트맵 (syscall_entry가 검사) */
+uint64_t syscall_fast_mask;
+
+/* NOTE: [Improve] syscall_entry가 swapgs 후 %gs로 접근하는 CPU별 임시 공간
+ * 전역 임시 변수(temp1, temp2) 대신 사용하며, 멤버 순서를 바꾸면
+ * userprog/syscall-entry.S의 오프셋도 함께 고쳐야 한다. */
+struct syscall_scratch
+{
+	uint64_t user_rsp;		/* 0: 사용자 rsp 임시 보관 */
+	struct task_state *tss; /* 8: ring0 rsp를 읽을 TSS */
+};
+static struct syscall_scratch syscall_scratch;
+
 void syscall_init(void)
 {
 	write_msr(MSR_STAR, ((uint64_t)SEL_UCSEG - 0x10) << 48 |
@@ -73,70 +166,61 @@ void syscall_init(void)
 	write_msr(MSR_SYSCALL_MASK,
 			  FLAG_IF | FLAG_TF | FLAG_DF | FLAG_IOPL | FLAG_AC | FLAG_NT);
 
+	/* NOTE: [Improve] syscall_entry의 swapgs가 CPU별 임시 공간을 가리키도록 설정 */
+	syscall_scratch.tss = tss_get();
+	write_msr(MSR_KERNEL_GS_BASE, (uint64_t)&syscall_scratch);
+
+	/* NOTE: [Improve] fast 핸들러가 있는 시스템 콜을 비트맵에 등록 */
+	ASSERT(SYSCALL_CNT <= 64);
+	for (size_t i = 0; i < SYSCALL_CNT; i++)
+		if (syscall_table[i].fast != NULL)
+			syscall_fast_mask |= (uint64_t)1 << i;
+
 	/* NOTE: [2.4] filesys_lock 초기화 */
 	lock_init(&filesys_lock);
+	futex_init();
+}
+
+/* NOTE: [Improve] 시스템 콜 진입 공통 처리 (집계, 프로세스 종료 확인) */
+static inline void syscall_enter(void)
+{
+	thread_current()->ext->ru.ru_nsyscalls++; /* NOTE: [Improve] 시스템 콜 횟수 집계 */
+
+	/* NOTE: [Improve] 프로세스가 종료 중이면 나머지 쓰레드도 여기서 종료 */
+	exit_group_check();
 }
 
 /* The main system call interface */
 void syscall_handler(struct intr_frame *f)
 {
 	// NOTE: [2.X] Your implementation goes here.
-	/* TODO: [2.5] fork 추가 */
 	uint64_t syscall_num = f->R.rax;
 	thread_current()->rsp = f->rsp;
-	switch (syscall_num)
-	{
-	case SYS_HALT: // 0
-		halt();
-		break;
-	case SYS_EXIT: // 1
-		exit(f->R.rdi);
-		break;
-	case SYS_FORK: // 2
-		f->R.rax = sys_fork(f->R.rdi, f);
-		break;
-	case SYS_EXEC: // 3
-		f->R.rax = exec(f->R.rdi);
-		break;
-	case SYS_WAIT: // 4
-		f->R.rax = wait(f->R.rdi);
-		break;
-	case SYS_CREATE: // 5
-		f->R.rax = create(f->R.rdi, f->R.rsi);
-		break;
-	case SYS_REMOVE: // 6
-		f->R.rax = remove(f->R.rdi);
-		break;
-	case SYS_OPEN: // 7
-		f->R.rax = open(f->R.rdi);
-		break;
-	case SYS_FILESIZE: // 8
-		f->R.rax = filesize(f->R.rdi);
-		break;
-	case SYS_READ: // 9
-		f->R.rax = read(f->R.rdi, f->R.rsi, f->R.rdx);
-		break;
-	case SYS_WRITE: // 10
-		f->R.rax = write(f->R.rdi, f->R.rsi, f->R.rdx);
-		break;
-	case SYS_SEEK: // 11
-		seek(f->R.rdi, f->R.rsi);
-		break;
-	case SYS_TELL: // 12
-		f->R.rax = tell(f->R.rdi);
-		break;
-	case SYS_CLOSE: // 13
-		close(f->R.rdi);
-		break;
-
-	// mmap, mmunmap 추가
-	case SYS_MMAP:
-		f->R.rax = mmap(f->R.rdi, f->R.rsi, f->R.rdx, f->R.r10, f->R.r8);
-		break;
-	case SYS_MUNMAP:
-		munmap(f->R.rdi);
-		break;
-	}
+	syscall_enter();
+
+	/* NOTE: [Improve] switch 대신 테이블로 분기 */
+	if (syscall_num < SYSCALL_CNT && syscall_table[syscall_num].slow != NULL)
+		syscall_table[syscall_num].slow(f);
+
+	/* NOTE: [Improve] 시스템 콜 도중 다른 쓰레드가 프로세스를 종료시켰으면 사용자 모드로 돌아가지 않음 */
+	exit_group_check();
+}
+
+/**
+ * @brief intr_frame 없이 처리하는 시스템 콜 진입점
+ *
+ * @param a1, a2, a3 시스템 콜 인자 (rdi, rsi, rdx)
+ * @param syscall_num syscall_fast_mask에 등록된 시스템 콜 번호
+ * @return 사용자에게 돌려줄 rax 값
+ */
+uint64_t syscall_fast_handler(uint64_t a1, uint64_t a2, uint64_t a3, uint64_t syscall_num)
+{
+	uint64_t ret;
+
+	syscall_enter();
+	ret = syscall_table[syscall_num].fast(a1, a2, a3);
+	exit_group_check();
+	return ret;
 }
 
 /* ---------- SYSCALL ---------- */
@@ -152,15 +236,70 @@ void exit(int status)
 {
 	/* 실행중인 스레드 구조체를 가져옴 */
 	struct thread *curr = thread_current();
+
+	/* NOTE: [Improve] 다른 쓰레드가 exit_group()으로 이미 프로세스를 종료시켰으면 그 status를 따름 */
+	if (curr->leader == curr)
+	{
+		enum intr_level old_level = intr_disable();
+		if (curr->group_exiting)
+			status = curr->exit_status;
+		curr->group_exiting = true;
+		intr_set_level(old_level);
+	}
 	/* NOTE: [2.3] 프로세스 디스크립터에 exit status 저장 */
 	curr->exit_status = status;
 
-	/* 프로세스 종료 메시지 출력, 출력 양식: “프로세스이름 : exit(종료상태 )” */
-	printf("%s: exit(%d)\n", curr->name, status);
+	/* 프로세스 종료 메시지 출력, 출력 양식: “프로세스이름 : exit(종료상태 )”
+	   NOTE: [Improve] uthread_create()로 만든 쓰레드는 자기 자신만 종료하므로 메시지를 출력하지 않음 */
+	if (curr->leader == curr)
+		printf("%s: exit(%d)\n", curr->name, status);
 	/* 스레드 종료 */
 	thread_exit();
 }
 
+/**
+ * @brief 현재 쓰레드가 속한 프로세스 전체를 STATUS로 종료시키는 함수 (fault, 잘못된 포인터 등)
+ * leader에 STATUS를 남기고 group_exiting을 설정한 뒤 futex에서 잠든 쓰레드를 깨운다.
+ * 나머지 쓰레드는 사용자 모드로 돌아가기 전에 exit_group_check()에서 종료되며,
+ * 종료 메시지는 leader가 종료하면서 출력한다.
+ *
+ * @param status 프로세스의 종료 status (이미 종료 중이면 무시)
+ */
+void exit_group(int status)
+{
+	struct thread *leader = thread_current()->leader;
+	enum intr_level old_level;
+	bool first;
+
+	old_level = intr_disable();
+	first = !leader->group_exiting;
+	if (first)
+	{
+		leader->group_exiting = true;
+		leader->exit_status = status;
+	}
+	intr_set_level(old_level);
+
+	if (first)
+		futex_release(leader);
+	exit_group_check();
+	NOT_REACHED();
+}
+
+/* NOTE: [Improve] 사용자 모드로 돌아가기 직전에 호출한다 (시스템 콜, 인터럽트 반환 경로).
+   프로세스가 종료 중이면 현재 쓰레드를 leader에 남은 status로 종료한다. */
+void exit_group_check(void)
+{
+	struct thread *leader = thread_current()->leader;
+
+	if (leader->group_exiting)
+	{
+		/* 외부 인터럽트 반환 경로에서는 인터럽트가 꺼진 채로 들어온다 */
+		intr_enable();
+		exit(leader->exit_status);
+	}
+}
+
 /* NOTE: [2.5] fork() 시스템 콜 구현 */
 pid_t sys_fork(const char *thread_name, struct intr_frame *f)
 {
@@ -173,6 +312,10 @@ pid_t exec(const char *cmd_line)
 {
 	check_address(cmd_line);
 
+	/* NOTE: [Improve] 다른 쓰레드가 주소 공간을 쓰고 있으면 교체할 수 없음 */
+	if (!process_single_threaded())
+		return -1;
+
 	char *cmd_line_cpy = palloc_get_page(0);
 	if (cmd_line_cpy == NULL)
 		exit(-1);
@@ -348,7 +491,30 @@ void close(int fd)
 void check_address(void *addr)
 {
 	if (addr == NULL || is_kernel_vaddr(addr))
-		exit(-1);
+		exit_group(-1);
+}
+
+/**
+ * @brief 현재 프로세스 또는 회수된 자식 프로세스들의 자원 사용량을 USAGE에 복사하는 시스템 콜
+ *
+ * @param who RUSAGE_SELF 또는 RUSAGE_CHILDREN
+ * @param usage 결과를 받을 사용자 버퍼
+ * @return 성공 시 0, WHO가 잘못되었으면 -1
+ */
+int getrusage(int who, struct rusage *usage)
+{
+	struct thread *curr = thread_current();
+
+	check_address(usage);
+	check_address((uint8_t *)usage + sizeof *usage - 1);
+
+	if (who == RUSAGE_SELF)
+		*usage = curr->ext->ru;
+	else if (who == RUSAGE_CHILDREN)
+		*usage = curr->ext->ru_children;
+	else
+		return -1;
+	return 0;
 }
 
 // map, mmunmap 추가
@@ -363,9 +529,6 @@ void *mmap(void *addr, size_t length, int writable, int fd, off_t offset)
 	if (!is_user_vaddr(addr) || !is_user_vaddr(addr + length))
 		return NULL;
 
-	if (spt_find_page(&thread_current()->spt, addr))
-		return NULL;
-
 	struct file *f = process_get_file(fd);
 	if (f == NULL)
 		return NULL;
@@ -373,10 +536,50 @@ void *mmap(void *addr, size_t length, int writable, int fd, off_t offset)
 	if (file_length(f) == 0 || (int)length <= 0)
 		return NULL;
 
-	return do_mmap(addr, length, writable, f, offset); // 파일이 매핑된 가상 주소 반환
+	/* NOTE: [Improve] 같은 spt를 쓰는 쓰레드끼리 직렬화 */
+	struct lock *vm_lock = &thread_current()->leader->vm_lock;
+	void *mapped = NULL;
+	lock_acquire(vm_lock);
+	if (!spt_find_page(&thread_current()->leader->spt, addr))
+		mapped = do_mmap(addr, length, writable, f, offset); // 파일이 매핑된 가상 주소 반환
+	lock_release(vm_lock);
+	return mapped;
 }
 
 void munmap(void *addr)
 {
+	struct lock *vm_lock = &thread_current()->leader->vm_lock;
+
+	lock_acquire(vm_lock);
 	do_munmap(addr);
+	lock_release(vm_lock);
+}
+
+/* NOTE: [Improve] 현재 프로세스의 주소 공간을 공유하는 쓰레드를 만드는 시스템 콜 */
+tid_t sys_thread_create(void *entry, void *func, void *aux, struct intr_frame *f)
+{
+	check_address(entry);
+	return process_thread_create(entry, func, aux, f);
+}
+
+/* NOTE: [Improve] 같은 프로세스의 쓰레드가 끝나기를 기다리는 시스템 콜 */
+int sys_thread_join(tid_t tid)
+{
+	return process_thread_join(tid);
+}
+
+/* NOTE: [Improve] 사용자 메모리 word 위에서 잠들거나 잠든 쓰레드를 깨우는 시스템 콜 */
+int futex(int *uaddr, int op, int val)
+{
+	check_address(uaddr);
+
+	switch (op)
+	{
+	case FUTEX_WAIT:
+		return futex_wait(uaddr, val);
+	case FUTEX_WAKE:
+		return futex_wake(uaddr, val);
+	default:
+		return -1;
+	}
 }
@@ -10,6 +10,9 @@ static bool file_backed_swap_in (struct page *page, void *kva);
 static bool file_backed_swap_out (struct page *page);
 static void file_backed_destroy (struct page *page);
 
+/* NOTE: [Improve] lazy load aux 전용 object cache */
+struct slab_cache file_page_cache;
+
 /* DO NOT MODIFY this struct */
 static const struct page_operations file_ops = {
 	.swap_in = file_backed_swap_in,
@@ -21,6 +24,7 @@ static const struct page_operations file_ops = {
 /* The initializer of file vm */
 void
 vm_file_init (void) {
+	slab_cache_init (&file_page_cache, "file_page", sizeof (struct file_page), NULL);
 }
 
 /* Initialize the file backed page */
@@ -98,7 +102,9 @@ do_mmap (void *addr, size_t length, int writable,
 		size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
 		size_t page_zero_bytes = PGSIZE - page_read_bytes;
 
-		struct file_page *aux = (struct file_page *)malloc(sizeof(struct file_page));
+		struct file_page *aux = slab_alloc(&file_page_cache);
+		if (aux == NULL)
+			return NULL;
 		aux->file = f;
 		aux->ofs = offset;
 		aux->read_bytes = page_read_bytes;
@@ -109,7 +115,7 @@ do_mmap (void *addr, size_t length, int writable,
 											writable, lazy_load_segment, aux))
 			return NULL;
 
-		struct page *p = spt_find_page(&thread_current()->spt, start_addr);
+		struct page *p = spt_find_page(&thread_current()->leader->spt, start_addr);
 		p->mapped_page_count = total_page_count; // munmap에서 매핑을 해제할 때 모든 페이지를 해제하기 위해 필요함
 
 		/* Advance. */
@@ -126,7 +132,7 @@ do_mmap (void *addr, size_t length, int writable,
 /* Do the munmap */
 void
 do_munmap (void *addr) {
-	struct supplemental_page_table *spt = &thread_current()->spt;
+	struct supplemental_page_table *spt = &thread_current()->leader->spt;
 	struct page *p = spt_find_page(spt, addr);
 	int count = p->mapped_page_count;
 	for (int i = 0; i < count; i++)
@@ -1,6 +1,7 @@
 /* vm.c: Generic interface for virtual memory objects. */
 
 #include "threads/malloc.h"
+#include "threads/slab.h"
 #include "vm/vm.h"
 #include "vm/inspect.h"
 #include "threads/vaddr.h"
@@ -8,6 +9,11 @@
 #include "kernel/hash.h"
 #include "userprog/process.h"
 #include "vm/file.h"
+/* NOTE: [Improve] struct page, struct frame 전용 object cache
+ * malloc의 2의 거듭제곱 반올림 없이 페이지 단위 slab에서 할당한다. */
+static struct slab_cache page_cache;
+static struct slab_cache frame_cache;
+
 /* Initializes the virtual memory subsystem by invoking each subsystem's
  * intialize codes. */
 void
@@ -26,6 +32,9 @@ vm_init (void) {
 	// Frame table init
 	list_init(&frame_table.ft_list);
 	lock_init(&frame_table_lock);
+
+	slab_cache_init(&page_cache, "page", sizeof(struct page), NULL);
+	slab_cache_init(&frame_cache, "frame", sizeof(struct frame), NULL);
 }
 
 /* Get the type of the page. This function is useful if you want to know the
@@ -56,7 +65,7 @@ vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable,
 
 	ASSERT (VM_TYPE(type) != VM_UNINIT)
 
-	struct supplemental_page_table *spt = &thread_current ()->spt;
+	struct supplemental_page_table *spt = &thread_current ()->leader->spt;
 	/* Check wheter the upage is already occupied or not. */
 	if (spt_find_page (spt, upage) == NULL) {
 		/* TODO: Create the page, fetch the initialier according to the VM type,
@@ -64,7 +73,10 @@ vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable,
 		 * TODO: should modify the field after calling the uninit_new. */
 
 		// printf("couldn't found spt page. new page malloc ");
-		struct page *page = calloc(1,sizeof(struct page));
+		/* NOTE: [Improve] uninit_new()이 page 전체를 초기화하므로 0으로 채울 필요 없음 */
+		struct page *page = slab_alloc(&page_cache);
+		if (page == NULL)
+			return false;
 		// printf("ok\n");
 		// printf("this page is pointing to %p\n", page);
 		bool (*page_initializer) (struct page *, enum vm_type, void *);
@@ -180,8 +192,10 @@ vm_get_frame (void) {
 		// printf("ANON SWAP OUT\n");
 	} 
 	else {
-		frame = (struct frame *) calloc(1, sizeof(struct frame));
+		frame = slab_alloc(&frame_cache);
+		ASSERT (frame != NULL);
 		frame->kva = kva;
+		frame->accessed = 0;
 		lock_acquire(&frame_table_lock);
 		list_push_back(&frame_table.ft_list, &frame->frame_list_elem);
 		lock_release(&frame_table_lock);
@@ -216,7 +230,7 @@ vm_handle_wp (struct page *page UNUSED) {
 bool vm_try_handle_fault(struct intr_frame *f UNUSED, void *addr UNUSED,
                          bool user UNUSED, bool write UNUSED, bool not_present UNUSED)
 {
-    struct supplemental_page_table *spt UNUSED = &thread_current()->spt;
+    struct supplemental_page_table *spt UNUSED = &thread_current()->leader->spt;
     struct page *page = NULL;
 
     if (addr == NULL)
@@ -262,7 +276,7 @@ bool vm_try_handle_fault(struct intr_frame *f UNUSED, void *addr UNUSED,
 void
 vm_dealloc_page (struct page *page) {
 	destroy (page);
-	free (page);
+	slab_free (&page_cache, page);
 }
 
 /* Claim the page that allocate on VA. */
@@ -270,7 +284,7 @@ bool
 vm_claim_page (void *va UNUSED) {
 	struct page *page = NULL;
 	/* TODO: Fill this function */
-	if ((page = spt_find_page(&thread_current()->spt, va))== NULL) return false; 
+	if ((page = spt_find_page(&thread_current()->leader->spt, va))== NULL) return false; 
 	return vm_do_claim_page (page);
 }
 
@@ -325,7 +339,9 @@ supplemental_page_table_copy (struct supplemental_page_table *dst UNUSED,
 		/* 2) type이 file이면 */
 		if (type == VM_FILE)
 		{
-			struct file_page *file_aux = malloc(sizeof(struct file_page));
+			struct file_page *file_aux = slab_alloc(&file_page_cache);
+			if (file_aux == NULL)
+				return false;
 			file_aux->file = src_page->file.file;
 			file_aux->ofs = src_page->file.ofs;
 			file_aux->read_bytes = src_page->file.read_bytes;
@@ -386,5 +402,5 @@ void hash_page_destroy(struct hash_elem *e, void *aux)
 {
 	struct page *page = hash_entry(e, struct page, hash_elem);
 	destroy(page);
-	free(page);
+	slab_free(&page_cache, page);
 }
\ No newline at end of file